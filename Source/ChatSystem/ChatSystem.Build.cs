@@ -41,7 +41,8 @@ public class ChatSystem : ModuleRules
 				"Slate",
 				"SlateCore",
 				"UMG",
-				"InputCore", "RenderCore", "RHI"
+				"InputCore", "RenderCore", "RHI",
+				"NetCore"
 				// ... add private dependencies that you statically link with here ...	
 			}
 		);
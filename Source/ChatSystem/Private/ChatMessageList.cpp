@@ -0,0 +1,123 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatMessageList.h"
+
+#include "Components/ChatComponent.h"
+#include "Components/RichTextBlock.h"
+#include "Engine/DataTable.h"
+#include "Slate/SChatMessageList.h"
+#include "Styling/SlateStyle.h"
+
+#define LOCTEXT_NAMESPACE "Titan"
+
+TSharedRef<SWidget> UChatMessageList::RebuildWidget()
+{
+	RebuildStyleSet();
+
+	MyMessageList = SNew(SChatMessageList)
+		.MaxMessages(MaxMessages)
+		.AutoScroll(AutoScroll)
+		.TextStyle(&DefaultTextStyle)
+		.DecoratorStyleSet(StyleInstance.Get());
+
+	if (ChatComponent)
+	{
+		TArray<FChatHistoryEntry> Entries;
+		ChatComponent->GetHistory().GetLast(MaxMessages, Entries);
+		MyMessageList->SetMessages(Entries);
+	}
+
+	return MyMessageList.ToSharedRef();
+}
+
+void UChatMessageList::SynchronizeProperties()
+{
+	Super::SynchronizeProperties();
+
+	if (MyMessageList.IsValid())
+	{
+		RebuildStyleSet();
+		MyMessageList->SetMaxMessages(MaxMessages);
+		MyMessageList->SetTextStyle(&DefaultTextStyle, StyleInstance.Get());
+	}
+}
+
+void UChatMessageList::ReleaseSlateResources(const bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	MyMessageList.Reset();
+	StyleInstance.Reset();
+}
+
+void UChatMessageList::SetChatComponent(UChatComponent* InChatComponent)
+{
+	if (ChatComponent)
+	{
+		ChatComponent->OnHistoryEntryAdded.Remove(HistoryEntryAddedHandle);
+		HistoryEntryAddedHandle.Reset();
+	}
+
+	ChatComponent = InChatComponent;
+
+	if (ChatComponent)
+	{
+		HistoryEntryAddedHandle = ChatComponent->OnHistoryEntryAdded.AddUObject(
+			this, &UChatMessageList::HandleHistoryEntryAdded);
+	}
+
+	if (MyMessageList.IsValid())
+	{
+		TArray<FChatHistoryEntry> Entries;
+		if (ChatComponent)
+		{
+			ChatComponent->GetHistory().GetLast(MaxMessages, Entries);
+		}
+		MyMessageList->SetMessages(Entries);
+	}
+}
+
+void UChatMessageList::AddMessage(const FChatHistoryEntry& Entry)
+{
+	if (MyMessageList.IsValid())
+	{
+		MyMessageList->AddMessage(Entry);
+	}
+}
+
+void UChatMessageList::ClearMessages()
+{
+	if (MyMessageList.IsValid())
+	{
+		MyMessageList->ClearMessages();
+	}
+}
+
+void UChatMessageList::HandleHistoryEntryAdded(const FChatHistoryEntry& Entry)
+{
+	AddMessage(Entry);
+}
+
+void UChatMessageList::RebuildStyleSet()
+{
+	StyleInstance = MakeShareable(new FSlateStyleSet(TEXT("ChatMessageListStyle")));
+
+	if (TextStyleSet && TextStyleSet->GetRowStruct()->IsChildOf(FRichTextStyleRow::StaticStruct()))
+	{
+		for (const auto& Entry : TextStyleSet->GetRowMap())
+		{
+			const FRichTextStyleRow* Row = reinterpret_cast<const FRichTextStyleRow*>(Entry.Value);
+			StyleInstance->Set(Entry.Key, Row->TextStyle);
+		}
+	}
+}
+
+#if WITH_EDITOR
+const FText UChatMessageList::GetPaletteCategory()
+{
+	return LOCTEXT("ChatSystem", "Chat System");
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -1,6 +1,42 @@
 // Copyright 2024 Iraj Mohtasham aurelion.net
 
 #include "ChatSystem.h"
+#include "ChatSystemLog.h"
+#include "ChatSystemStats.h"
+#include "ChatSystem/ChatAuditLog.h"
+
+DEFINE_LOG_CATEGORY(LogChatSystem);
+DEFINE_LOG_CATEGORY(LogChatMessages);
+DEFINE_LOG_CATEGORY(LogChatPing);
+DEFINE_LOG_CATEGORY(LogChatUI);
+
+DEFINE_STAT(STAT_ChatSystem_SendString);
+DEFINE_STAT(STAT_ChatSystem_NotifyMessageReceived);
+DEFINE_STAT(STAT_ChatSystem_SpawnPingAtLocation);
+DEFINE_STAT(STAT_ChatSystem_PingIsNetRelevantFor);
+DEFINE_STAT(STAT_ChatSystem_WidgetComponentTick);
+DEFINE_STAT(STAT_ChatSystem_DrawWidgetToRenderTarget);
+DEFINE_STAT(STAT_ChatSystem_POIUpdate);
+DEFINE_STAT(STAT_ChatSystem_MessagesSent);
+DEFINE_STAT(STAT_ChatSystem_MessagesReceived);
+DEFINE_STAT(STAT_ChatSystem_ClientMessageRpcs);
+DEFINE_STAT(STAT_ChatSystem_ProjectedWidgets);
+DEFINE_STAT(STAT_ChatSystem_ActivePings);
+DEFINE_STAT(STAT_ChatSystem_RenderTargetMemory);
+
+CSV_DEFINE_CATEGORY_MODULE(CHATSYSTEM_API, ChatSystem, true);
+
+int32 FChatSystemCounters::ActivePings = 0;
+int64 FChatSystemCounters::RenderTargetBytes = 0;
+int64 FChatSystemCounters::ClientMessageRpcs = 0;
+int64 FChatSystemCounters::ClientMessagesSent = 0;
+
+void FChatSystemCounters::RecordCsvFrame()
+{
+	CSV_CUSTOM_STAT(ChatSystem, ActivePings, ActivePings, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ChatSystem, RenderTargetMB, static_cast<float>(RenderTargetBytes / (1024.0 * 1024.0)),
+	                ECsvCustomStatOp::Set);
+}
 
 #define LOCTEXT_NAMESPACE "FChatSystemModule"
 
@@ -14,7 +50,7 @@ void FChatSystemModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
-	
+	FChatAuditLog::Get().Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,132 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatAnnouncementLog.h"
+
+#include "ChatSystem/ChatCompression.h"
+#include "ChatSystem/ChatManager.h"
+#include "Components/ChatComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
+
+void FChatAnnouncementItem::PostReplicatedAdd(const FChatAnnouncementArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->DeliverToLocalPlayers(*this);
+	}
+}
+
+AChatAnnouncementLog::AChatAnnouncementLog()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	// Only replicated when an announcement is appended, new connections still receive the current log
+	NetDormancy = DORM_DormantAll;
+	// Replays already get announcements from AChatReplayRecorder, recording the log as well would play them twice
+	bRelevantForNetworkReplays = false;
+	Announcements.Owner = this;
+}
+
+void AChatAnnouncementLog::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UChatManager* Manager = UChatManager::GetInstance(GetWorld()))
+	{
+		Manager->SetAnnouncementLog(this);
+	}
+}
+
+void AChatAnnouncementLog::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+	if (Manager && Manager->GetAnnouncementLog() == this)
+	{
+		Manager->SetAnnouncementLog(nullptr);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AChatAnnouncementLog::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AChatAnnouncementLog, Announcements);
+}
+
+void AChatAnnouncementLog::Append(const FString& Message, const FString& SenderName)
+{
+	// Drop the oldest announcements so the log and the initial replication of late joiners stay small
+	const int32 NumToRemove = Announcements.Items.Num() - FMath::Max(1, MaxAnnouncements) + 1;
+	if (NumToRemove > 0)
+	{
+		Announcements.Items.RemoveAt(0, NumToRemove);
+		Announcements.MarkArrayDirty();
+	}
+
+	// 255 is used as the TeamIndex for server-wide announcements
+	FChatAnnouncementItem& Item = Announcements.Items.AddDefaulted_GetRef();
+	Item.Sequence = NextSequence++;
+	Item.Message = FChatMessage(255, Message, INDEX_NONE, SenderName);
+	// The log replicates to every client, an announcement over the limit would fail the bunch for all of them
+	FChatCompression::ClampToMaxBytes(Item.Message.Message);
+	Announcements.MarkItemDirty(Item);
+	FlushNetDormancy();
+
+	// Replication never reaches the local players of a listen server
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		DeliverToLocalPlayers(Item);
+	}
+
+	// Server side listeners on remote players' components got every announcement before the log existed, keep that
+	if (const UChatManager* Manager = UChatManager::GetInstance(GetWorld()))
+	{
+		for (UChatComponent* ChatComponent : Manager->GetAllComponents())
+		{
+			const AActor* ComponentOwner = ChatComponent->GetOwner();
+			if (ComponentOwner && ComponentOwner->GetNetConnection())
+			{
+				ChatComponent->NotifyAnnouncementOnServer(Item.Message);
+			}
+		}
+	}
+}
+
+void AChatAnnouncementLog::DeliverToLocalPlayers(const FChatAnnouncementItem& Item) const
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			if (UChatComponent* ChatComponent = UChatComponent::GetChatComponentFromPlayerState(
+				PlayerController->PlayerState))
+			{
+				ChatComponent->ReceiveAnnouncement(this, Item.Sequence, Item.Message);
+			}
+		}
+	}
+}
+
+void AChatAnnouncementLog::DeliverPending(UChatComponent* Component) const
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	for (const FChatAnnouncementItem& Item : Announcements.Items)
+	{
+		Component->ReceiveAnnouncement(this, Item.Sequence, Item.Message);
+	}
+}
@@ -0,0 +1,144 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatAuditLog.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+
+static int32 GChatAuditLogEnabled = 0;
+static FAutoConsoleVariableRef CVarChatAuditLogEnabled(
+	TEXT("ChatSystem.AuditLog"),
+	GChatAuditLogEnabled,
+	TEXT("Write every delivered chat message to Saved/Logs/ChatAudit-<time>.log on a background thread")
+);
+
+static float GChatAuditLogFlushInterval = 1.f;
+static FAutoConsoleVariableRef CVarChatAuditLogFlushInterval(
+	TEXT("ChatSystem.AuditLogFlushInterval"),
+	GChatAuditLogFlushInterval,
+	TEXT("Seconds the audit log writer collects messages before writing them as one batch")
+);
+
+FChatAuditLog& FChatAuditLog::Get()
+{
+	static FChatAuditLog Instance;
+	return Instance;
+}
+
+bool FChatAuditLog::IsEnabled()
+{
+	return GChatAuditLogEnabled != 0;
+}
+
+void FChatAuditLog::Record(const FString& SenderName, const uint8 TeamIndex, const FName Channel,
+                           const FString& Message)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	Get().Enqueue({FDateTime::UtcNow(), SenderName, TeamIndex, Channel, Message});
+}
+
+void FChatAuditLog::Enqueue(FEntry&& Entry)
+{
+	if (bStopping)
+	{
+		return;
+	}
+
+	StartThread();
+	Queue.Enqueue(MoveTemp(Entry));
+}
+
+void FChatAuditLog::StartThread()
+{
+	if (Thread)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&StartLock);
+	if (!Thread && !bStopping)
+	{
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+		Thread = FRunnableThread::Create(this, TEXT("ChatAuditLog"), 0, TPri_BelowNormal);
+	}
+}
+
+uint32 FChatAuditLog::Run()
+{
+	const FString FileName = FPaths::ProjectLogDir() / FString::Printf(
+		TEXT("ChatAudit-%s.log"), *FDateTime::Now().ToString());
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FileName, true);
+
+	// Reused between batches so steady state writing doesn't allocate
+	FString Buffer;
+	while (!bStopping)
+	{
+		WakeEvent->Wait(FTimespan::FromSeconds(FMath::Max(0.01f, GChatAuditLogFlushInterval)));
+		WriteQueued(Buffer);
+	}
+	WriteQueued(Buffer);
+
+	delete File;
+	File = nullptr;
+	return 0;
+}
+
+void FChatAuditLog::WriteQueued(FString& Buffer)
+{
+	Buffer.Reset();
+
+	FEntry Entry;
+	while (Queue.Dequeue(Entry))
+	{
+		Buffer += FString::Printf(TEXT("%s\t%s\t%d\t%s\t"), *Entry.Time.ToIso8601(), *Entry.SenderName,
+		                          Entry.TeamIndex, *Entry.Channel.ToString());
+		// One line per message
+		Buffer.Append(Entry.Message.Replace(TEXT("\n"), TEXT(" ")));
+		Buffer.AppendChar(TEXT('\n'));
+	}
+
+	if (File && Buffer.Len() > 0)
+	{
+		const FTCHARToUTF8 Utf8(*Buffer, Buffer.Len());
+		File->Write(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+		File->Flush();
+	}
+}
+
+void FChatAuditLog::Stop()
+{
+	bStopping = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FChatAuditLog::Shutdown()
+{
+	FScopeLock Lock(&StartLock);
+	if (!Thread)
+	{
+		return;
+	}
+
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+FChatAuditLog::~FChatAuditLog()
+{
+	Shutdown();
+}
@@ -0,0 +1,259 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatCompression.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+
+namespace
+{
+	enum class EChatStringEncoding : uint8
+	{
+		// Default FString serialization
+		Native = 0,
+		Utf8 = 1,
+		Utf8Zlib = 2,
+	};
+
+	int32 GChatCompressionThreshold = 256;
+	FAutoConsoleVariableRef CVarChatCompressionThreshold(
+		TEXT("ChatSystem.CompressionThreshold"),
+		GChatCompressionThreshold,
+		TEXT("Chat strings with at least this many UTF-8 bytes are zlib compressed. 0 disables the compact encoding."),
+		ECVF_Default);
+
+	int32 GChatMaxStringBytes = 16384;
+	FAutoConsoleVariableRef CVarChatMaxStringBytes(
+		TEXT("ChatSystem.MaxStringBytes"),
+		GChatMaxStringBytes,
+		TEXT("Largest chat string in UTF-8 bytes sent or accepted over the network. Longer strings are cut before sending."),
+		ECVF_Default);
+
+	FCriticalSection StatsLock;
+	FChatCompressionStats Stats;
+
+	void RecordString(const int32 RawBytes, const int32 EncodedBytes, const bool bCompressed)
+	{
+		FScopeLock Lock(&StatsLock);
+		++Stats.Strings;
+		Stats.CompressedStrings += bCompressed ? 1 : 0;
+		Stats.RawBytes += RawBytes;
+		Stats.EncodedBytes += EncodedBytes;
+	}
+
+	// Saving side of SerializeString, the string already fits in the limit
+	bool WriteString(FArchive& Ar, FString& String)
+	{
+		// Bytes the default serialization would write: one per character for ANSI, two otherwise, plus terminator
+		const bool bPureAnsi = FCString::IsPureAnsi(*String);
+		const int32 RawBytes = String.IsEmpty() ? 0 : (String.Len() + 1) * (bPureAnsi ? 1 : 2);
+
+		if (GChatCompressionThreshold <= 0 || (bPureAnsi && String.Len() < GChatCompressionThreshold))
+		{
+			uint8 Encoding = static_cast<uint8>(EChatStringEncoding::Native);
+			Ar.SerializeBits(&Encoding, 2);
+			Ar << String;
+			RecordString(RawBytes, RawBytes, false);
+			return true;
+		}
+
+		FTCHARToUTF8 Utf8(*String, String.Len());
+		const int32 Utf8Size = Utf8.Length();
+
+		if (Utf8Size >= GChatCompressionThreshold)
+		{
+			int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Utf8Size);
+			TArray<uint8> Compressed;
+			Compressed.SetNumUninitialized(CompressedSize);
+			if (FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Utf8.Get(), Utf8Size) &&
+				CompressedSize < Utf8Size)
+			{
+				uint8 Encoding = static_cast<uint8>(EChatStringEncoding::Utf8Zlib);
+				Ar.SerializeBits(&Encoding, 2);
+				uint32 PackedSize = Utf8Size;
+				uint32 PackedCompressedSize = CompressedSize;
+				Ar.SerializeIntPacked(PackedSize);
+				Ar.SerializeIntPacked(PackedCompressedSize);
+				Ar.Serialize(Compressed.GetData(), CompressedSize);
+				RecordString(RawBytes, CompressedSize, true);
+				return true;
+			}
+		}
+
+		uint8 Encoding = static_cast<uint8>(EChatStringEncoding::Utf8);
+		Ar.SerializeBits(&Encoding, 2);
+		uint32 PackedSize = Utf8Size;
+		Ar.SerializeIntPacked(PackedSize);
+		Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8Size);
+		RecordString(RawBytes, Utf8Size, false);
+		return true;
+	}
+
+	FAutoConsoleCommand CmdChatCompressionStats(
+		TEXT("ChatSystem.CompressionStats"),
+		TEXT("Prints how many bytes the compact chat string encoding saved."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			const FChatCompressionStats Current = FChatCompression::GetStats();
+			UE_LOG(LogNet, Display, TEXT("Chat strings: %lld (%lld compressed), %lld raw bytes, %lld sent, %lld saved"),
+			       Current.Strings, Current.CompressedStrings, Current.RawBytes, Current.EncodedBytes,
+			       Current.GetBytesSaved());
+		}));
+}
+
+int32 FChatCompression::GetMaxStringBytes()
+{
+	return FMath::Max(0, GChatMaxStringBytes);
+}
+
+bool FChatCompression::ExceedsMaxBytes(const FString& String)
+{
+	return GetFittingLength(String) < String.Len();
+}
+
+bool FChatCompression::ClampToMaxBytes(FString& String)
+{
+	const int32 FittingLength = GetFittingLength(String);
+	if (FittingLength == String.Len())
+	{
+		return false;
+	}
+
+	String.LeftInline(FittingLength, false);
+	return true;
+}
+
+int32 FChatCompression::GetFittingLength(const FString& String)
+{
+	// A character takes at most 4 UTF-8 bytes, most strings don't need to be measured
+	const int32 MaxBytes = GetMaxStringBytes();
+	if (String.Len() <= MaxBytes / 4)
+	{
+		return String.Len();
+	}
+
+	int32 Bytes = 0;
+	for (int32 Index = 0; Index < String.Len(); Index++)
+	{
+		const uint32 Char = static_cast<uint32>(String[Index]);
+		int32 CharBytes;
+		int32 CharLength = 1;
+		if (Char < 0x80)
+		{
+			CharBytes = 1;
+		}
+		else if (Char < 0x800)
+		{
+			CharBytes = 2;
+		}
+		else if (Char >= 0xD800 && Char <= 0xDBFF && Index + 1 < String.Len())
+		{
+			// UTF-16 surrogate pair, cut before or after both halves
+			CharBytes = 4;
+			CharLength = 2;
+		}
+		else
+		{
+			CharBytes = Char < 0x10000 ? 3 : 4;
+		}
+
+		if (Bytes + CharBytes > MaxBytes)
+		{
+			return Index;
+		}
+		Bytes += CharBytes;
+		Index += CharLength - 1;
+	}
+	return String.Len();
+}
+
+bool FChatCompression::SerializeString(FArchive& Ar, FString& String)
+{
+	if (Ar.IsSaving())
+	{
+		// The reading side fails the whole bunch, and with it the connection, on strings over the limit
+		const int32 FittingLength = GetFittingLength(String);
+		if (FittingLength < String.Len())
+		{
+			UE_LOG(LogNet, Warning, TEXT("Chat string of %d characters cut to %d to fit ChatSystem.MaxStringBytes"),
+			       String.Len(), FittingLength);
+			FString Clamped = String.Left(FittingLength);
+			return WriteString(Ar, Clamped);
+		}
+		return WriteString(Ar, String);
+	}
+
+	uint8 Encoding = 0;
+	Ar.SerializeBits(&Encoding, 2);
+
+	if (Encoding == static_cast<uint8>(EChatStringEncoding::Native))
+	{
+		Ar << String;
+		return !Ar.IsError();
+	}
+
+	uint32 Utf8Size = 0;
+	Ar.SerializeIntPacked(Utf8Size);
+
+	// Sizes come from the remote side so they are checked before anything is allocated
+	if (Ar.IsError() || Utf8Size > static_cast<uint32>(FMath::Max(0, GChatMaxStringBytes)))
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	TArray<uint8> Utf8;
+	Utf8.SetNumUninitialized(Utf8Size);
+
+	if (Encoding == static_cast<uint8>(EChatStringEncoding::Utf8Zlib))
+	{
+		uint32 CompressedSize = 0;
+		Ar.SerializeIntPacked(CompressedSize);
+		if (Ar.IsError() || CompressedSize == 0 || CompressedSize > Utf8Size)
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(CompressedSize);
+		Ar.Serialize(Compressed.GetData(), CompressedSize);
+		if (Ar.IsError() || !FCompression::UncompressMemory(NAME_Zlib, Utf8.GetData(), Utf8Size, Compressed.GetData(),
+		                                                    CompressedSize))
+		{
+			Ar.SetError();
+			return false;
+		}
+	}
+	else if (Encoding == static_cast<uint8>(EChatStringEncoding::Utf8))
+	{
+		Ar.Serialize(Utf8.GetData(), Utf8Size);
+	}
+	else
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	if (Ar.IsError())
+	{
+		return false;
+	}
+
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Utf8Size);
+	String = FString(Converted.Length(), Converted.Get());
+	return true;
+}
+
+FChatCompressionStats FChatCompression::GetStats()
+{
+	FScopeLock Lock(&StatsLock);
+	return Stats;
+}
+
+void FChatCompression::ResetStats()
+{
+	FScopeLock Lock(&StatsLock);
+	Stats = FChatCompressionStats();
+}
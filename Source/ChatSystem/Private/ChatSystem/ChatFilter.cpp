@@ -0,0 +1,113 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatFilter.h"
+
+FChatWordFilter::FChatWordFilter(const TArray<FString>& Words, const bool bInRejectMessages,
+                                 const TCHAR InMaskCharacter)
+	: bRejectMessages(bInRejectMessages), MaskCharacter(InMaskCharacter)
+{
+	// Root state
+	Nodes.AddDefaulted();
+
+	// Trie of the lower case words
+	for (const FString& Word : Words)
+	{
+		if (Word.IsEmpty())
+		{
+			continue;
+		}
+
+		int32 State = 0;
+		for (const TCHAR Character : Word)
+		{
+			const TCHAR Lower = FChar::ToLower(Character);
+			const int32* Next = Nodes[State].Next.Find(Lower);
+			if (Next)
+			{
+				State = *Next;
+			}
+			else
+			{
+				const int32 NewState = Nodes.AddDefaulted();
+				Nodes[State].Next.Add(Lower, NewState);
+				State = NewState;
+			}
+		}
+		Nodes[State].MatchLength = FMath::Max(Nodes[State].MatchLength, Word.Len());
+	}
+
+	// Fail links in breadth first order so the fail state of a node is always finished before the node
+	TArray<int32> Queue;
+	for (const TPair<TCHAR, int32>& Child : Nodes[0].Next)
+	{
+		Queue.Add(Child.Value);
+	}
+	for (int32 QueueIndex = 0; QueueIndex < Queue.Num(); ++QueueIndex)
+	{
+		const int32 State = Queue[QueueIndex];
+		for (const TPair<TCHAR, int32>& Child : Nodes[State].Next)
+		{
+			const int32 Fail = State == 0 ? 0 : Step(Nodes[State].Fail, Child.Key);
+			FNode& ChildNode = Nodes[Child.Value];
+			ChildNode.Fail = Fail == Child.Value ? 0 : Fail;
+			ChildNode.MatchLength = FMath::Max(ChildNode.MatchLength, Nodes[ChildNode.Fail].MatchLength);
+			Queue.Add(Child.Value);
+		}
+	}
+}
+
+int32 FChatWordFilter::Step(int32 State, const TCHAR Character) const
+{
+	for (;;)
+	{
+		if (const int32* Next = Nodes[State].Next.Find(Character))
+		{
+			return *Next;
+		}
+		if (State == 0)
+		{
+			return 0;
+		}
+		State = Nodes[State].Fail;
+	}
+}
+
+EChatFilterResult FChatWordFilter::Filter(FString& Message) const
+{
+	if (Nodes.Num() <= 1)
+	{
+		return EChatFilterResult::Accept;
+	}
+
+	bool bMatched = false;
+	int32 State = 0;
+	// Characters before this index are already masked
+	int32 MaskedUntil = 0;
+	TArray<TCHAR, FString::AllocatorType>& Characters = Message.GetCharArray();
+
+	for (int32 Index = 0; Index < Message.Len(); ++Index)
+	{
+		State = Step(State, FChar::ToLower(Characters[Index]));
+		const int32 MatchLength = Nodes[State].MatchLength;
+		if (MatchLength == 0)
+		{
+			continue;
+		}
+
+		bMatched = true;
+		if (bRejectMessages)
+		{
+			return EChatFilterResult::Reject;
+		}
+
+		// Masking doesn't change the automaton state, it already consumed the original character
+		for (int32 MaskIndex = FMath::Max(Index - MatchLength + 1, MaskedUntil); MaskIndex <= Index; ++MaskIndex)
+		{
+			Characters[MaskIndex] = MaskCharacter;
+		}
+		MaskedUntil = Index + 1;
+	}
+
+	return bMatched ? EChatFilterResult::Modified : EChatFilterResult::Accept;
+}
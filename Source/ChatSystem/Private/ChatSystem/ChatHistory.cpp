@@ -0,0 +1,120 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatHistory.h"
+
+#include "ChatSystem/ChatRichText.h"
+
+FChatHistory::FChatHistory(const int32 InCapacity)
+	: Capacity(FMath::Max(1, InCapacity))
+{
+}
+
+void FChatHistory::SetCapacity(int32 InCapacity)
+{
+	InCapacity = FMath::Max(1, InCapacity);
+	if (InCapacity == Capacity)
+	{
+		return;
+	}
+
+	TArray<FChatHistoryEntry> Kept;
+	GetLast(InCapacity, Kept);
+
+	Capacity = InCapacity;
+	Entries.Reset();
+	Count = Kept.Num();
+	if (Count > 0)
+	{
+		Entries.SetNum(Capacity);
+		for (FChatHistoryEntry& Entry : Kept)
+		{
+			Entries[Entry.Sequence % Capacity] = MoveTemp(Entry);
+		}
+	}
+}
+
+void FChatHistory::Reset()
+{
+	Entries.Reset();
+	Count = 0;
+}
+
+const FChatHistoryEntry& FChatHistory::Add(const FString& SenderName, const uint8 TeamIndex, const float Timestamp,
+                                           const FString& Message,
+                                           const TSharedPtr<const FChatParsedMessage>& ParsedMessage,
+                                           const FName Channel)
+{
+	// Slots are allocated on the first message so players who never chat don't pay for the buffer
+	if (Entries.Num() != Capacity)
+	{
+		Entries.SetNum(Capacity);
+	}
+
+	FChatHistoryEntry& Entry = Entries[NextSequence % Capacity];
+	Entry.Sequence = NextSequence++;
+	Entry.TeamIndex = TeamIndex;
+	Entry.Channel = Channel;
+	Entry.Timestamp = Timestamp;
+
+	// Reset keeps the allocation of the overwritten message so steady state chat doesn't allocate
+	Entry.SenderName.Reset();
+	Entry.SenderName.Append(SenderName);
+	Entry.Message.Reset();
+	Entry.Message.Append(Message);
+	Entry.ParsedMessage = ParsedMessage;
+
+	Count = FMath::Min(Count + 1, Capacity);
+	return Entry;
+}
+
+const FChatHistoryEntry* FChatHistory::Find(const int32 Sequence) const
+{
+	if (Sequence < GetFirstSequence() || Sequence >= NextSequence)
+	{
+		return nullptr;
+	}
+	return &GetBySequence(Sequence);
+}
+
+void FChatHistory::GetLast(const int32 InCount, TArray<FChatHistoryEntry>& OutEntries) const
+{
+	GetSince(NextSequence - FMath::Clamp(InCount, 0, Count), OutEntries);
+}
+
+void FChatHistory::GetSince(const int32 Sequence, TArray<FChatHistoryEntry>& OutEntries) const
+{
+	const int32 Start = FMath::Max(Sequence, GetFirstSequence());
+	OutEntries.Reserve(OutEntries.Num() + FMath::Max(0, NextSequence - Start));
+	for (int32 Current = Start; Current < NextSequence; ++Current)
+	{
+		OutEntries.Add(GetBySequence(Current));
+	}
+}
+
+void FChatHistory::GetByTeam(const uint8 TeamIndex, const int32 MaxCount, TArray<FChatHistoryEntry>& OutEntries) const
+{
+	const int32 FirstIndex = OutEntries.Num();
+
+	// Walk from the newest message back so only the needed entries are visited
+	for (int32 Current = NextSequence - 1; Current >= GetFirstSequence() && OutEntries.Num() - FirstIndex < MaxCount;
+	     --Current)
+	{
+		const FChatHistoryEntry& Entry = GetBySequence(Current);
+		if (Entry.TeamIndex == TeamIndex)
+		{
+			OutEntries.Add(Entry);
+		}
+	}
+
+	// Return oldest first like the other queries
+	for (int32 Low = FirstIndex, High = OutEntries.Num() - 1; Low < High; ++Low, --High)
+	{
+		OutEntries.Swap(Low, High);
+	}
+}
+
+const FChatHistoryEntry& FChatHistory::GetBySequence(const int32 Sequence) const
+{
+	return Entries[Sequence % Capacity];
+}
@@ -0,0 +1,582 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatManager.h"
+
+#include "Async/Async.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/World.h"
+#include "ChatSystem/ChatAnnouncementLog.h"
+#include "ChatSystem/ChatReplayRecorder.h"
+#include "ChatSystemStats.h"
+#include "Components/ChatComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+static float GChatProximityCellSize = 2500.f;
+static FAutoConsoleVariableRef CVarChatProximityCellSize(
+	TEXT("ChatSystem.ProximityCellSize"),
+	GChatProximityCellSize,
+	TEXT("Size of the grid cells used to find players for proximity chat. Should be close to the usual chat radius")
+);
+
+static float GChatProximityUpdateInterval = 0.25f;
+static FAutoConsoleVariableRef CVarChatProximityUpdateInterval(
+	TEXT("ChatSystem.ProximityUpdateInterval"),
+	GChatProximityUpdateInterval,
+	TEXT("Seconds between updates of the positions of pawns that moved, used by proximity chat")
+);
+
+UChatManager* UChatManager::GetInstance(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UChatManager>() : nullptr;
+}
+
+void UChatManager::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UChatManager::OnWorldPostActorTick);
+
+	if (FilteredWords.Num() > 0)
+	{
+		AddMessageFilter(MakeShared<FChatWordFilter, ESPMode::ThreadSafe>(FilteredWords, bRejectFilteredMessages));
+	}
+}
+
+void UChatManager::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	TArray<UChatComponent*> Tracked;
+	ProximityTracking.GetKeys(Tracked);
+	for (UChatComponent* Component : Tracked)
+	{
+		StopProximityTracking(Component);
+	}
+
+	Super::Deinitialize();
+}
+
+void UChatManager::RegisterComponent(UChatComponent* Component)
+{
+	if (!Component || Components.Contains(Component))
+	{
+		return;
+	}
+
+	Components.Add(Component);
+	InvalidatePingRelevancy();
+	Teams.FindOrAdd(Component->GetTeamIndex()).Members.Add(Component);
+	Names.FindOrAdd(Component->GetPlayerName()).Members.Add(Component);
+
+	if (bProximityGridActive)
+	{
+		StartProximityTracking(Component);
+	}
+
+	// Pick up subscriptions made before the component was registered
+	for (const FName& Channel : Component->GetSubscribedChannels())
+	{
+		SubscribeToChannel(Component, Channel);
+	}
+}
+
+void UChatManager::UnregisterComponent(UChatComponent* Component)
+{
+	if (Components.Remove(Component) == 0)
+	{
+		return;
+	}
+	PendingFlush.Remove(Component);
+	ProximityGrid.Remove(Component);
+	StopProximityTracking(Component);
+	InvalidatePingRelevancy();
+
+	if (FChatRecipientList* Team = Teams.Find(Component->GetTeamIndex()))
+	{
+		Team->Members.Remove(Component);
+	}
+
+	if (FChatRecipientList* Name = Names.Find(Component->GetPlayerName()))
+	{
+		Name->Members.Remove(Component);
+		if (Name->Members.Num() == 0)
+		{
+			Names.Remove(Component->GetPlayerName());
+		}
+	}
+
+	for (const FName& Channel : Component->GetSubscribedChannels())
+	{
+		if (FChatRecipientList* Subscribers = Channels.Find(Channel))
+		{
+			Subscribers->Members.Remove(Component);
+			if (Subscribers->Members.Num() == 0)
+			{
+				Channels.Remove(Channel);
+			}
+		}
+	}
+}
+
+void UChatManager::UpdateTeam(UChatComponent* Component, const uint8 OldTeamIndex)
+{
+	if (!Component || OldTeamIndex == Component->GetTeamIndex() || !Components.Contains(Component))
+	{
+		return;
+	}
+
+	if (FChatRecipientList* OldTeam = Teams.Find(OldTeamIndex))
+	{
+		OldTeam->Members.Remove(Component);
+	}
+	Teams.FindOrAdd(Component->GetTeamIndex()).Members.Add(Component);
+	InvalidatePingRelevancy();
+}
+
+void UChatManager::UpdatePlayerName(UChatComponent* Component, const FString& OldPlayerName)
+{
+	if (!Component || OldPlayerName == Component->GetPlayerName() || !Components.Contains(Component))
+	{
+		return;
+	}
+
+	if (FChatRecipientList* OldName = Names.Find(OldPlayerName))
+	{
+		OldName->Members.Remove(Component);
+		if (OldName->Members.Num() == 0)
+		{
+			Names.Remove(OldPlayerName);
+		}
+	}
+	Names.FindOrAdd(Component->GetPlayerName()).Members.Add(Component);
+	// Ping mutes are keyed by name
+	InvalidatePingRelevancy();
+}
+
+const TArray<UChatComponent*>& UChatManager::GetAllComponents() const
+{
+	return Components;
+}
+
+const TArray<UChatComponent*>& UChatManager::GetTeamMembers(const uint8 TeamIndex) const
+{
+	static const TArray<UChatComponent*> NoMembers;
+	const FChatRecipientList* Team = Teams.Find(TeamIndex);
+	return Team ? Team->Members : NoMembers;
+}
+
+const TArray<UChatComponent*>& UChatManager::GetComponentsByPlayerName(const FString& PlayerName) const
+{
+	static const TArray<UChatComponent*> NoMembers;
+	const FChatRecipientList* Name = Names.Find(PlayerName);
+	return Name ? Name->Members : NoMembers;
+}
+
+UChatComponent* UChatManager::FindComponentByPlayerName(const FString& PlayerName) const
+{
+	const TArray<UChatComponent*>& Matches = GetComponentsByPlayerName(PlayerName);
+	return Matches.Num() > 0 ? Matches[0] : nullptr;
+}
+
+void UChatManager::SubscribeToChannel(UChatComponent* Component, const FName Channel)
+{
+	if (Component && !Channel.IsNone())
+	{
+		Channels.FindOrAdd(Channel).Members.AddUnique(Component);
+	}
+}
+
+void UChatManager::UnsubscribeFromChannel(UChatComponent* Component, const FName Channel)
+{
+	if (FChatRecipientList* Subscribers = Channels.Find(Channel))
+	{
+		Subscribers->Members.Remove(Component);
+		if (Subscribers->Members.Num() == 0)
+		{
+			Channels.Remove(Channel);
+		}
+	}
+}
+
+const TArray<UChatComponent*>& UChatManager::GetChannelSubscribers(const FName Channel) const
+{
+	static const TArray<UChatComponent*> NoMembers;
+	const FChatRecipientList* Subscribers = Channels.Find(Channel);
+	return Subscribers ? Subscribers->Members : NoMembers;
+}
+
+FChatRateLimitStats UChatManager::GetRateLimitStats() const
+{
+	FChatRateLimitStats Total;
+	for (const UChatComponent* Component : Components)
+	{
+		const FChatRateLimitStats& Stats = Component->GetRateLimitStats();
+		Total.AcceptedMessages += Stats.AcceptedMessages;
+		Total.RejectedMessages += Stats.RejectedMessages;
+		Total.AcceptedPings += Stats.AcceptedPings;
+		Total.RejectedPings += Stats.RejectedPings;
+	}
+	return Total;
+}
+
+void UChatManager::AddMessageFilter(const TSharedRef<const IChatMessageFilter, ESPMode::ThreadSafe>& Filter)
+{
+	MessageFilters.Add(Filter);
+}
+
+void UChatManager::RemoveMessageFilter(const TSharedRef<const IChatMessageFilter, ESPMode::ThreadSafe>& Filter)
+{
+	MessageFilters.Remove(Filter);
+}
+
+void UChatManager::FilterMessage(UChatComponent* Sender, const FString& Message,
+                                 TFunction<void(UChatComponent*, const FString&)>&& Deliver)
+{
+	// Nothing to wait for, unless earlier messages are still being filtered and would be overtaken
+	if (MessageFilters.Num() == 0 && PendingFilteredMessages.Num() == 0)
+	{
+		Deliver(Sender, Message);
+		return;
+	}
+
+	const int32 Ticket = NextFilterTicket++;
+	FPendingFilteredMessage& Pending = PendingFilteredMessages.Add(Ticket);
+	Pending.Sender = Sender;
+	Pending.Deliver = MoveTemp(Deliver);
+
+	// The task works on copies, the filter list can change while it runs
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask,
+	          [WeakThis = TWeakObjectPtr<UChatManager>(this), Filters = MessageFilters, Ticket, Text = Message]() mutable
+	          {
+		          bool bAccepted = true;
+		          for (const TSharedRef<const IChatMessageFilter, ESPMode::ThreadSafe>& Filter : Filters)
+		          {
+			          if (Filter->Filter(Text) == EChatFilterResult::Reject)
+			          {
+				          bAccepted = false;
+				          break;
+			          }
+		          }
+
+		          AsyncTask(ENamedThreads::GameThread, [WeakThis, Ticket, bAccepted, Text = MoveTemp(Text)]() mutable
+		          {
+			          if (UChatManager* Manager = WeakThis.Get())
+			          {
+				          Manager->OnMessageFiltered(Ticket, bAccepted, MoveTemp(Text));
+			          }
+		          });
+	          });
+}
+
+void UChatManager::OnMessageFiltered(const int32 Ticket, const bool bAccepted, FString&& Message)
+{
+	FPendingFilteredMessage* Finished = PendingFilteredMessages.Find(Ticket);
+	if (!Finished)
+	{
+		return;
+	}
+	Finished->bFinished = true;
+	Finished->bAccepted = bAccepted;
+	Finished->Message = MoveTemp(Message);
+
+	// Deliver every finished message that is next in line
+	while (FPendingFilteredMessage* Pending = PendingFilteredMessages.Find(NextDeliveryTicket))
+	{
+		if (!Pending->bFinished)
+		{
+			break;
+		}
+
+		const FPendingFilteredMessage Current = MoveTemp(*Pending);
+		PendingFilteredMessages.Remove(NextDeliveryTicket);
+		++NextDeliveryTicket;
+
+		UChatComponent* Sender = Current.Sender.Get();
+		if (!Current.bAccepted)
+		{
+			UE_LOG(LogChatMessages, Verbose, TEXT("Filtered out message from %s"),
+			       Sender ? *Sender->GetPlayerName() : TEXT("None"));
+		}
+		else if (Sender)
+		{
+			Current.Deliver(Sender, Current.Message);
+		}
+	}
+}
+
+void UChatManager::RequestFlush(UChatComponent* Component)
+{
+	PendingFlush.Add(Component);
+}
+
+AChatAnnouncementLog* UChatManager::GetOrSpawnAnnouncementLog()
+{
+	UWorld* World = GetWorld();
+	if (AnnouncementLog || !World || World->GetNetMode() == NM_Client)
+	{
+		return AnnouncementLog;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+	AnnouncementLog = World->SpawnActor<AChatAnnouncementLog>(SpawnParameters);
+	return AnnouncementLog;
+}
+
+void UChatManager::SetAnnouncementLog(AChatAnnouncementLog* InAnnouncementLog)
+{
+	AnnouncementLog = InAnnouncementLog;
+}
+
+void UChatManager::RecordReplayMessage(const FString& SenderName, const uint8 TeamIndex, const FName Channel,
+                                       const FString& Message)
+{
+	if (AChatReplayRecorder* Recorder = GetOrSpawnReplayRecorder())
+	{
+		FChatReplayEvent Event;
+		// 255 is used as the TeamIndex for server-wide announcements
+		Event.Type = TeamIndex == 255 ? EChatReplayEventType::Announcement : EChatReplayEventType::Message;
+		Event.SenderName = SenderName;
+		Event.TeamIndex = TeamIndex;
+		Event.Channel = Channel;
+		Event.Message = Message;
+		Recorder->Record(Event);
+	}
+}
+
+void UChatManager::RecordReplayPing(const FString& SenderName, const uint8 TeamIndex, const FVector& Location)
+{
+	if (AChatReplayRecorder* Recorder = GetOrSpawnReplayRecorder())
+	{
+		FChatReplayEvent Event;
+		Event.Type = EChatReplayEventType::Ping;
+		Event.SenderName = SenderName;
+		Event.TeamIndex = TeamIndex;
+		Event.Location = Location;
+		Recorder->Record(Event);
+	}
+}
+
+void UChatManager::SetReplayRecorder(AChatReplayRecorder* InReplayRecorder)
+{
+	ReplayRecorder = InReplayRecorder;
+}
+
+AChatReplayRecorder* UChatManager::GetOrSpawnReplayRecorder()
+{
+	// Only a pointer check while no replay is recorded
+	UWorld* World = GetWorld();
+	const UDemoNetDriver* DemoNetDriver = World ? World->GetDemoNetDriver() : nullptr;
+	if (!DemoNetDriver || !DemoNetDriver->IsRecording() || World->GetNetMode() == NM_Client)
+	{
+		return nullptr;
+	}
+
+	if (!ReplayRecorder)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.ObjectFlags |= RF_Transient;
+		ReplayRecorder = World->SpawnActor<AChatReplayRecorder>(SpawnParameters);
+	}
+	return ReplayRecorder;
+}
+
+void UChatManager::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	FChatSystemCounters::RecordCsvFrame();
+
+	if (bProximityGridActive)
+	{
+		TimeSinceProximityUpdate += DeltaSeconds;
+		if (TimeSinceProximityUpdate >= GChatProximityUpdateInterval)
+		{
+			TimeSinceProximityUpdate = 0.f;
+			UpdateProximityGrid();
+		}
+	}
+
+	if (PendingFlush.Num() == 0)
+	{
+		return;
+	}
+
+	// Swap out the list first so flushing can safely queue messages for the next frame
+	TArray<UChatComponent*> ToFlush = MoveTemp(PendingFlush);
+	PendingFlush.Reset();
+	for (UChatComponent* Component : ToFlush)
+	{
+		if (IsValid(Component))
+		{
+			Component->FlushOutbox();
+		}
+	}
+}
+
+void UChatManager::GetNearbyComponents(UChatComponent* Sender, const float Radius,
+                                       TArray<UChatComponent*>& OutComponents)
+{
+	if (!bProximityGridActive)
+	{
+		// First use of proximity chat, build the grid once and keep it updated from pawn movement from now on
+		bProximityGridActive = true;
+		for (UChatComponent* Component : Components)
+		{
+			StartProximityTracking(Component);
+		}
+		UpdateProximityGrid();
+	}
+
+	// The sender's own position is refreshed so the query is centered correctly
+	if (!UpdateProximityLocation(Sender))
+	{
+		return;
+	}
+
+	const APawn* Pawn = Cast<APlayerState>(Sender->GetOwner())->GetPawn();
+	ProximityGrid.Query(Pawn->GetActorLocation(), Radius, OutComponents);
+}
+
+void UChatManager::UpdateProximityGrid()
+{
+	ProximityGrid.SetCellSize(GChatProximityCellSize);
+	if (DirtyProximity.Num() == 0)
+	{
+		return;
+	}
+
+	// Swap out the set first, updating a location doesn't move the pawn but stay safe against re-entrance
+	TSet<UChatComponent*> ToUpdate = MoveTemp(DirtyProximity);
+	DirtyProximity.Reset();
+	for (UChatComponent* Component : ToUpdate)
+	{
+		if (Components.Contains(Component))
+		{
+			UpdateProximityLocation(Component);
+		}
+	}
+}
+
+void UChatManager::StartProximityTracking(UChatComponent* Component)
+{
+	if (ProximityTracking.Contains(Component))
+	{
+		return;
+	}
+
+	FProximityTracking& Tracking = ProximityTracking.Add(Component);
+	const APlayerState* PlayerState = Cast<APlayerState>(Component->GetOwner());
+	if (APlayerController* Controller = PlayerState ? Cast<APlayerController>(PlayerState->GetOwner()) : nullptr)
+	{
+		Tracking.Controller = Controller;
+		Tracking.NewPawnHandle = Controller->GetOnNewPawnNotifier().AddWeakLambda(this, [this, Component](APawn* NewPawn)
+		{
+			TrackProximityPawn(Component, NewPawn);
+		});
+	}
+
+	TrackProximityPawn(Component, PlayerState ? PlayerState->GetPawn() : nullptr);
+}
+
+void UChatManager::StopProximityTracking(UChatComponent* Component)
+{
+	FProximityTracking Tracking;
+	if (!ProximityTracking.RemoveAndCopyValue(Component, Tracking))
+	{
+		return;
+	}
+
+	if (APlayerController* Controller = Tracking.Controller.Get())
+	{
+		Controller->GetOnNewPawnNotifier().Remove(Tracking.NewPawnHandle);
+	}
+	if (USceneComponent* PawnRoot = Tracking.PawnRoot.Get())
+	{
+		PawnRoot->TransformUpdated.Remove(Tracking.MovedHandle);
+	}
+	DirtyProximity.Remove(Component);
+}
+
+void UChatManager::TrackProximityPawn(UChatComponent* Component, APawn* Pawn)
+{
+	FProximityTracking* Tracking = ProximityTracking.Find(Component);
+	if (!Tracking)
+	{
+		return;
+	}
+
+	if (USceneComponent* OldRoot = Tracking->PawnRoot.Get())
+	{
+		OldRoot->TransformUpdated.Remove(Tracking->MovedHandle);
+	}
+	Tracking->PawnRoot = nullptr;
+	Tracking->MovedHandle.Reset();
+
+	if (USceneComponent* Root = Pawn ? Pawn->GetRootComponent() : nullptr)
+	{
+		Tracking->PawnRoot = Root;
+		Tracking->MovedHandle = Root->TransformUpdated.AddWeakLambda(
+			this, [this, Component](USceneComponent*, EUpdateTransformFlags, ETeleportType)
+			{
+				DirtyProximity.Add(Component);
+			});
+	}
+
+	// Possession changed, the location has to be read again or removed from the grid
+	DirtyProximity.Add(Component);
+}
+
+bool UChatManager::UpdateProximityLocation(UChatComponent* Component)
+{
+	const APlayerState* PlayerState = Cast<APlayerState>(Component->GetOwner());
+	const APawn* Pawn = PlayerState ? PlayerState->GetPawn() : nullptr;
+	if (!Pawn)
+	{
+		ProximityGrid.Remove(Component);
+		return false;
+	}
+
+	ProximityGrid.Update(Component, Pawn->GetActorLocation());
+	return true;
+}
+
+void UChatManager::SetSenderName(const int32 SenderId, const FString& Name)
+{
+	if (SenderId != INDEX_NONE)
+	{
+		SenderNames.Add(SenderId, Name);
+	}
+}
+
+FString UChatManager::ResolveSenderName(const int32 SenderId)
+{
+	if (const FString* Name = SenderNames.Find(SenderId))
+	{
+		return *Name;
+	}
+
+	// The name replicated before the player id, look it up once and cache it
+	if (const AGameStateBase* GameState = GetWorld()->GetGameState())
+	{
+		for (APlayerState* PlayerState : GameState->PlayerArray)
+		{
+			if (PlayerState && PlayerState->GetPlayerId() == SenderId)
+			{
+				if (const UChatComponent* Component = UChatComponent::GetChatComponentFromPlayerState(PlayerState))
+				{
+					return SenderNames.Add(SenderId, Component->GetPlayerName());
+				}
+			}
+		}
+	}
+
+	return TEXT("None");
+}
@@ -0,0 +1,90 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatReplayRecorder.h"
+
+#include "ChatSystem/ChatManager.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+void FChatReplayEvent::PostReplicatedAdd(const FChatReplayEventArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnReplayEvent.Broadcast(*this);
+	}
+}
+
+AChatReplayRecorder::AChatReplayRecorder()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	// Replicate through the demo net driver only, the game net driver never considers the recorder
+	NetDriverName = NAME_DemoNetDriver;
+	Events.Owner = this;
+}
+
+void AChatReplayRecorder::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UChatManager* Manager = UChatManager::GetInstance(GetWorld()))
+	{
+		Manager->SetReplayRecorder(this);
+	}
+}
+
+void AChatReplayRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+	if (Manager && Manager->GetReplayRecorder() == this)
+	{
+		Manager->SetReplayRecorder(nullptr);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AChatReplayRecorder::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Only written to replays, live connections never receive the events
+	DOREPLIFETIME_CONDITION(AChatReplayRecorder, Events, COND_ReplayOnly);
+}
+
+void AChatReplayRecorder::Record(FChatReplayEvent& Event)
+{
+	const UDemoNetDriver* DemoNetDriver = GetWorld()->GetDemoNetDriver();
+	Event.Timestamp = DemoNetDriver ? DemoNetDriver->GetDemoCurrentTime() : GetWorld()->GetTimeSeconds();
+
+	// Trim in batches so a full recorder doesn't shift the whole array and dirty it on every event
+	const int32 Capacity = FMath::Max(1, MaxEvents);
+	if (Events.Items.Num() >= Capacity + FMath::Max(1, Capacity / 4))
+	{
+		Events.Items.RemoveAt(0, Events.Items.Num() - Capacity + 1, false);
+		Events.MarkArrayDirty();
+	}
+
+	Events.MarkItemDirty(Events.Items.Add_GetRef(Event));
+}
+
+TArray<FChatReplayEvent> AChatReplayRecorder::GetEventsBetween(const float StartTime, const float EndTime) const
+{
+	TArray<FChatReplayEvent> Result;
+
+	// Events are recorded in time order
+	for (const FChatReplayEvent& Event : Events.Items)
+	{
+		if (Event.Timestamp > EndTime)
+		{
+			break;
+		}
+		if (Event.Timestamp >= StartTime)
+		{
+			Result.Add(Event);
+		}
+	}
+	return Result;
+}
@@ -0,0 +1,76 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatRichText.h"
+
+#include "Framework/Text/RichTextMarkupProcessing.h"
+
+namespace ChatRichText
+{
+	void OffsetRange(FTextRange& Range, const int32 Offset)
+	{
+		Range.BeginIndex += Offset;
+		Range.EndIndex += Offset;
+	}
+}
+
+TSharedRef<const FChatParsedMessage> FChatParsedMessage::Parse(const FString& Input)
+{
+	// Parsers are stateless, share one instance for every message
+	static const TSharedRef<FDefaultRichTextMarkupParser> MarkupParser = FDefaultRichTextMarkupParser::Create();
+
+	const TSharedRef<FChatParsedMessage> Parsed = MakeShared<FChatParsedMessage>();
+	MarkupParser->Process(Parsed->Lines, Input, Parsed->Text);
+	return Parsed;
+}
+
+FChatCachedMarkupParser::FChatCachedMarkupParser(const TSharedRef<const FChatParsedMessage>& InParsedMessage,
+                                                 const FString& InPrefix)
+	: ParsedMessage(InParsedMessage), Prefix(InPrefix)
+{
+}
+
+void FChatCachedMarkupParser::Process(TArray<FTextLineParseResults>& Results, const FString& Input, FString& Output)
+{
+	Output = Prefix;
+	Output.Append(ParsedMessage->Text);
+	Results = ParsedMessage->Lines;
+
+	if (Results.Num() == 0)
+	{
+		FTextLineParseResults& Line = Results.Add_GetRef(FTextLineParseResults(FTextRange(0, Output.Len())));
+		Line.Runs.Add(FTextRunParseResults(FString(), FTextRange(0, Output.Len())));
+		return;
+	}
+
+	const int32 Offset = Prefix.Len();
+	if (Offset == 0)
+	{
+		return;
+	}
+
+	// Shift every range past the prefix, the prefix itself becomes a plain run at the start of the first line
+	for (int32 LineIndex = 0; LineIndex < Results.Num(); ++LineIndex)
+	{
+		FTextLineParseResults& Line = Results[LineIndex];
+		if (LineIndex == 0)
+		{
+			Line.Range.EndIndex += Offset;
+		}
+		else
+		{
+			ChatRichText::OffsetRange(Line.Range, Offset);
+		}
+
+		for (FTextRunParseResults& Run : Line.Runs)
+		{
+			ChatRichText::OffsetRange(Run.OriginalRange, Offset);
+			ChatRichText::OffsetRange(Run.ContentRange, Offset);
+			for (auto& MetaData : Run.MetaData)
+			{
+				ChatRichText::OffsetRange(MetaData.Value, Offset);
+			}
+		}
+	}
+	Results[0].Runs.Insert(FTextRunParseResults(FString(), FTextRange(0, Offset)), 0);
+}
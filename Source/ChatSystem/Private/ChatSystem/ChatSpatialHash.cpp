@@ -0,0 +1,126 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatSpatialHash.h"
+
+#include "EngineDefines.h"
+
+FChatSpatialHash::FChatSpatialHash(const float InCellSize)
+	: CellSize(FMath::Max(1.f, InCellSize))
+{
+}
+
+void FChatSpatialHash::SetCellSize(const float InCellSize)
+{
+	const float NewCellSize = FMath::Max(1.f, InCellSize);
+	if (NewCellSize == CellSize)
+	{
+		return;
+	}
+
+	CellSize = NewCellSize;
+	Cells.Reset();
+	for (auto& Pair : Locations)
+	{
+		Pair.Value.Cell = GetCell(Pair.Value.Location);
+		Cells.FindOrAdd(Pair.Value.Cell).Add(const_cast<UChatComponent*>(Pair.Key));
+	}
+}
+
+void FChatSpatialHash::Update(UChatComponent* Component, const FVector& Location)
+{
+	const FIntPoint Cell = GetCell(Location);
+	if (FTrackedLocation* Tracked = Locations.Find(Component))
+	{
+		Tracked->Location = Location;
+		if (Tracked->Cell == Cell)
+		{
+			return;
+		}
+
+		RemoveFromCell(Component, Tracked->Cell);
+		Tracked->Cell = Cell;
+	}
+	else
+	{
+		Locations.Add(Component, {Location, Cell});
+	}
+	Cells.FindOrAdd(Cell).Add(Component);
+}
+
+void FChatSpatialHash::Remove(UChatComponent* Component)
+{
+	FTrackedLocation Tracked;
+	if (Locations.RemoveAndCopyValue(Component, Tracked))
+	{
+		RemoveFromCell(Component, Tracked.Cell);
+	}
+}
+
+void FChatSpatialHash::Reset()
+{
+	Cells.Reset();
+	Locations.Reset();
+}
+
+void FChatSpatialHash::Query(const FVector& Center, const float Radius, TArray<UChatComponent*>& OutComponents) const
+{
+	// Nothing lives outside the world bounds, this also keeps the cell coordinates from overflowing
+	const float CellRadius = FMath::Min(Radius, static_cast<float>(WORLD_MAX));
+	const FIntPoint MinCell = GetCell(Center - FVector(CellRadius, CellRadius, 0.f));
+	const FIntPoint MaxCell = GetCell(Center + FVector(CellRadius, CellRadius, 0.f));
+	const float RadiusSquared = FMath::Square(Radius);
+
+	const auto AddInRange = [&](const TArray<UChatComponent*>& Cell)
+	{
+		for (UChatComponent* Component : Cell)
+		{
+			if (FVector::DistSquared(Locations.FindChecked(Component).Location, Center) <= RadiusSquared)
+			{
+				OutComponents.Add(Component);
+			}
+		}
+	};
+
+	// A radius much larger than the cell size would visit mostly empty cells, walk the occupied cells instead
+	const int64 NumCellsInRange = (static_cast<int64>(MaxCell.X) - MinCell.X + 1) * (static_cast<int64>(MaxCell.Y) - MinCell.Y + 1);
+	if (NumCellsInRange > Cells.Num())
+	{
+		for (const auto& Pair : Cells)
+		{
+			if (Pair.Key.X >= MinCell.X && Pair.Key.X <= MaxCell.X && Pair.Key.Y >= MinCell.Y && Pair.Key.Y <= MaxCell.Y)
+			{
+				AddInRange(Pair.Value);
+			}
+		}
+		return;
+	}
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			if (const TArray<UChatComponent*>* Cell = Cells.Find(FIntPoint(X, Y)))
+			{
+				AddInRange(*Cell);
+			}
+		}
+	}
+}
+
+FIntPoint FChatSpatialHash::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FChatSpatialHash::RemoveFromCell(UChatComponent* Component, const FIntPoint& Cell)
+{
+	if (TArray<UChatComponent*>* Members = Cells.Find(Cell))
+	{
+		Members->RemoveSingleSwap(Component);
+		if (Members->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
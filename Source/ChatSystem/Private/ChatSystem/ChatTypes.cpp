@@ -0,0 +1,74 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatSystem/ChatTypes.h"
+
+#include "ChatSystem/ChatCompression.h"
+
+bool FChatMessage::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << TeamIndex;
+
+	// One bit decides if the sender is sent as a packed id or as a full name
+	uint8 bHasSenderId = SenderId != INDEX_NONE;
+	Ar.SerializeBits(&bHasSenderId, 1);
+	if (bHasSenderId)
+	{
+		uint32 PackedSenderId = static_cast<uint32>(SenderId);
+		Ar.SerializeIntPacked(PackedSenderId);
+		SenderId = static_cast<int32>(PackedSenderId);
+	}
+	else
+	{
+		SenderId = INDEX_NONE;
+		Ar << SenderName;
+	}
+
+	// Channel names are only written for channel messages
+	uint8 bHasChannel = !Channel.IsNone();
+	Ar.SerializeBits(&bHasChannel, 1);
+	if (bHasChannel)
+	{
+		UPackageMap::StaticSerializeName(Ar, Channel);
+	}
+	else
+	{
+		Channel = NAME_None;
+	}
+
+	bOutSuccess = FChatCompression::SerializeString(Ar, Message) && !Ar.IsError();
+	return true;
+}
+
+bool FChatEncodedString::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = FChatCompression::SerializeString(Ar, Text) && !Ar.IsError();
+	return true;
+}
+
+bool FChatTokenBucket::TryConsume(const double Now, const float TokensPerSecond, const float BurstSize)
+{
+	if (TokensPerSecond <= 0.f)
+	{
+		return true;
+	}
+
+	// Start full so the first burst is never limited
+	if (Tokens < 0.f)
+	{
+		Tokens = BurstSize;
+	}
+	else
+	{
+		Tokens = FMath::Min(BurstSize, Tokens + static_cast<float>(Now - LastRefillTime) * TokensPerSecond);
+	}
+	LastRefillTime = Now;
+
+	if (Tokens < 1.f)
+	{
+		return false;
+	}
+
+	Tokens -= 1.f;
+	return true;
+}
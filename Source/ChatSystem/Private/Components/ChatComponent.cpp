@@ -1,21 +1,27 @@
 // Copyright 2024 Iraj Mohtasham aurelion.net 
 
 #include "Components/ChatComponent.h"
-#include "EngineUtils.h"
-#include "Engine/DemoNetDriver.h"
+#include "ChatSystem/ChatAnnouncementLog.h"
+#include "ChatSystem/ChatManager.h"
+#include "ChatSystem/ChatRichText.h"
+#include "ChatSystem/ChatAuditLog.h"
+#include "ChatSystem/ChatCompression.h"
+#include "ChatSystemStats.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
 #include "GameFramework/PlayerInput.h"
 #include "Kismet/GameplayStatics.h"
 #include "PingSystem/PingActor.h"
+#include "PingSystem/PingManager.h"
 
-// Define a custom log category for the chat system
-DEFINE_LOG_CATEGORY(LogChatSystem)
+const FName UChatComponent::LocalChannel(TEXT("Local"));
 
 // Constructor for the ChatComponent
 UChatComponent::UChatComponent() :
 	MinTimeBetweenPings(0.2f)
 {
-	// Allow this component to tick
-	PrimaryComponentTick.bCanEverTick = true;
+	// Everything is event driven, the ping cooldown is computed from timestamps
+	PrimaryComponentTick.bCanEverTick = false;
 	SetIsReplicatedByDefault(true);
 }
 
@@ -24,25 +30,58 @@ void UChatComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	History.SetCapacity(HistoryCapacity);
+
 	// If this is the server, set the player's name to the first player's name
 	if (GetOwnerRole() == ROLE_Authority)
 	{
-	
+		// Register with the chat manager so messages are only fanned out to actual recipients
+		ChatManager = UChatManager::GetInstance(GetWorld());
+		if (ChatManager)
+		{
+			ChatManager->RegisterComponent(this);
+		}
+
 		SetPlayerName(	Cast<APlayerState>(GetOwner())->GetPlayerName());
 	}
+	else
+	{
+		// Seed the local name table so messages from this player can be resolved by id
+		OnRep_PlayerName();
+
+		// Catch up on announcements replicated before the local player's component existed
+		const APlayerController* PlayerController = Cast<APlayerController>(GetOwner()->GetOwner());
+		const UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+		if (PlayerController && PlayerController->IsLocalController() && Manager && Manager->GetAnnouncementLog())
+		{
+			Manager->GetAnnouncementLog()->DeliverPending(this);
+		}
+	}
 
 	// Setup input mappings for chat system
 	UPlayerInput::AddEngineDefinedActionMapping(FInputActionKeyMapping("ChatKey", ChatOpenKey));
 	UPlayerInput::AddEngineDefinedActionMapping(FInputActionKeyMapping("AllChat", AllChatOpenKey, MustHoldShiftForAllChatKey));
 }
 
-// Called every frame
-void UChatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+// Called when the component is removed from play
+void UChatComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-	
-	// Decrement the ping timer each frame
-	PingTimer -= DeltaTime;
+	if (ChatManager)
+	{
+		// Held messages are waiting for a connection that is backed up and going away, sending them now would be the
+		// reliable burst the cap exists to prevent
+		if (CappedOutbox.Num() > 0)
+		{
+			UE_LOG(LogChatMessages, Log, TEXT("Discarding %d held chat messages for leaving player %s"), CappedOutbox.Num(),
+			       *PlayerName);
+			CappedOutbox.Reset();
+		}
+		FlushOutbox();
+		ChatManager->UnregisterComponent(this);
+		ChatManager = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Get the team index for the player
@@ -54,7 +93,10 @@ uint8 UChatComponent::GetTeamIndex() const
 // Send a chat message
 void UChatComponent::SendString(const FString& Input, bool SendToAll)
 {
-	UE_LOG(LogChatSystem, Log, TEXT("Sending String: %s %s"), *Input, SendToAll ? TEXT("Sending To All") : TEXT("Sending To Team"));
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_SendString);
+	CSV_SCOPED_TIMING_STAT(ChatSystem, SendString);
+
+	UE_LOG(LogChatMessages, Verbose, TEXT("Sending String: %s %s"), *Input, SendToAll ? TEXT("Sending To All") : TEXT("Sending To Team"));
 
 	// Check if the input message is empty, and ignore it if so
 	if (Input.IsEmpty())
@@ -62,10 +104,19 @@ void UChatComponent::SendString(const FString& Input, bool SendToAll)
 		return;
 	}
 
+	// Longer messages would fail to replicate and get the connection closed, cut them once for every recipient
+	if (FChatCompression::ExceedsMaxBytes(Input))
+	{
+		FString Clamped = Input;
+		FChatCompression::ClampToMaxBytes(Clamped);
+		SendString(Clamped, SendToAll);
+		return;
+	}
+
 	// Check if the player name is empty or "None," and handle it based on the setting
 	if (PlayerName == TEXT("None") || PlayerName.IsEmpty())
 	{
-		UE_LOG(LogTemp, Error, TEXT("No Player Name"));
+		UE_LOG(LogChatMessages, Warning, TEXT("No Player Name"));
 		if (RejectMessagesWithNoPlayerName)
 		{
 			// If configured to reject messages with no player name, ignore the message
@@ -88,37 +139,218 @@ void UChatComponent::SendString(const FString& Input, bool SendToAll)
 	else
 	{
 		// Server-side handling of the message
-
-		// Check if the player is banned and ignore the message if so
-		if (BannedPlayers.Find(PlayerName) != INDEX_NONE)
+		if (!CanSendOnServer(Input))
 		{
-			UE_LOG(LogChatSystem, Log, TEXT("Message from Banned player %s will be ignored. Message: %s"), *PlayerName, *Input);
-			// Make a server announcement to the player that they are banned
-			MakeServerAnnouncementToPlayer(BanMessage, PlayerName);
 			return;
 		}
 
-		// Iterate through all player controllers and send the message to relevant players
-		for (auto It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		// Fan-out continues once the message went through the filters
+		ChatManager->FilterMessage(this, Input, [SendToAll](UChatComponent* Sender, const FString& Filtered)
 		{
-			UChatComponent* ChatComponent = GetChatComponent(It->Get());
-			if (ChatComponent)
-			{
-				// Check if the message should be sent to this player based on team index or if it's a global message
-				if (ChatComponent->MyTeamIndex == MyTeamIndex || SendToAll)
-				{
-					// Notify the receiving player about the message
-					ChatComponent->NotifyMessageReceived(MyTeamIndex, Input, PlayerName);
-				}
-			}
+			Sender->DeliverFilteredMessage(Filtered, SendToAll, NAME_None);
+		});
+	}
+}
+
+// Send a filtered message to its recipients (server-side only)
+void UChatComponent::DeliverFilteredMessage(const FString& Input, const bool SendToAll, const FName Channel)
+{
+	if (!ChatManager)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_ChatSystem_MessagesSent);
+	CSV_CUSTOM_STAT(ChatSystem, MessagesSent, 1, ECsvCustomStatOp::Accumulate);
+	ChatManager->RecordReplayMessage(PlayerName, MyTeamIndex, Channel, Input);
+	FChatAuditLog::Record(PlayerName, MyTeamIndex, Channel, Input);
+
+	if (Channel == LocalChannel)
+	{
+		// The chat manager's grid only returns players in the cells around the sender
+		TArray<UChatComponent*> Recipients;
+		ChatManager->GetNearbyComponents(this, ProximityChatRadius, Recipients);
+		for (UChatComponent* ChatComponent : Recipients)
+		{
+			ChatComponent->NotifyMessageReceived(MyTeamIndex, Input, PlayerName, GetSenderId(), LocalChannel);
+		}
+	}
+	else if (!Channel.IsNone())
+	{
+		for (UChatComponent* ChatComponent : ChatManager->GetChannelSubscribers(Channel))
+		{
+			ChatComponent->NotifyMessageReceived(MyTeamIndex, Input, PlayerName, GetSenderId(), Channel);
+		}
+	}
+	else
+	{
+		// Send the message to the whole server or only to the members of the sender's team
+		const TArray<UChatComponent*>& Recipients = SendToAll
+			                                            ? ChatManager->GetAllComponents()
+			                                            : ChatManager->GetTeamMembers(MyTeamIndex);
+		for (UChatComponent* ChatComponent : Recipients)
+		{
+			// Notify the receiving player about the message
+			ChatComponent->NotifyMessageReceived(MyTeamIndex, Input, PlayerName, GetSenderId());
+		}
+	}
+}
+
+// Server side checks before a message is fanned out
+bool UChatComponent::CanSendOnServer(const FString& Input)
+{
+	// Check if the player is banned and ignore the message if so
+	if (BannedPlayers.Contains(PlayerNameKey))
+	{
+		UE_LOG(LogChatMessages, Verbose, TEXT("Message from Banned player %s will be ignored. Message: %s"), *PlayerName, *Input);
+		// Tell the banned player directly, no need to resolve them by name
+		NotifyMessageReceived(255, BanMessage, ServerMessageSenderName);
+		return false;
+	}
+
+	return ChatManager != nullptr;
+}
+
+// Send a chat message to the subscribers of a channel
+void UChatComponent::SendStringToChannel(const FString& Input, const FName Channel)
+{
+	if (Input.IsEmpty() || Channel.IsNone())
+	{
+		return;
+	}
+
+	if (FChatCompression::ExceedsMaxBytes(Input))
+	{
+		FString Clamped = Input;
+		FChatCompression::ClampToMaxBytes(Clamped);
+		SendStringToChannel(Clamped, Channel);
+		return;
+	}
+
+	if (GetOwnerRole() < ROLE_Authority)
+	{
+		SendStringToChannelOnServer(Input, Channel.ToString());
+		return;
+	}
+
+	if (!CanSendOnServer(Input))
+	{
+		return;
+	}
+
+	// Only subscribers can talk on a channel
+	if (!SubscribedChannels.Contains(Channel))
+	{
+		UE_LOG(LogChatMessages, Verbose, TEXT("%s is not subscribed to channel %s"), *PlayerName, *Channel.ToString());
+		return;
+	}
+
+	ChatManager->FilterMessage(this, Input, [Channel](UChatComponent* Sender, const FString& Filtered)
+	{
+		// Subscription may have ended while the message was filtered
+		if (Sender->IsSubscribedToChannel(Channel))
+		{
+			Sender->DeliverFilteredMessage(Filtered, false, Channel);
 		}
+	});
+}
+
+// Send a chat message to the players near this player's pawn
+void UChatComponent::SendLocalString(const FString& Input)
+{
+	if (Input.IsEmpty())
+	{
+		return;
+	}
+
+	if (FChatCompression::ExceedsMaxBytes(Input))
+	{
+		FString Clamped = Input;
+		FChatCompression::ClampToMaxBytes(Clamped);
+		SendLocalString(Clamped);
+		return;
+	}
+
+	if (GetOwnerRole() < ROLE_Authority)
+	{
+		SendLocalStringOnServer(Input);
+		return;
+	}
+
+	if (!CanSendOnServer(Input))
+	{
+		return;
+	}
+
+	ChatManager->FilterMessage(this, Input, [](UChatComponent* Sender, const FString& Filtered)
+	{
+		Sender->DeliverFilteredMessage(Filtered, false, LocalChannel);
+	});
+}
+
+// Send a chat message to nearby players (called on the server)
+void UChatComponent::SendLocalStringOnServer_Implementation(const FChatEncodedString& Input)
+{
+	if (ConsumeMessageToken())
+	{
+		SendLocalString(Input.Text);
+	}
+}
+
+// Send a chat message to a channel (called on the server)
+void UChatComponent::SendStringToChannelOnServer_Implementation(const FChatEncodedString& Input, const FString& Channel)
+{
+	// Client picked name, find it without adding to the name table and only accept channels someone subscribed to
+	const FName ChannelName = Channel.Len() < NAME_SIZE ? FName(*Channel, FNAME_Find) : NAME_None;
+	if (ChannelName.IsNone() || !ChatManager || !ChatManager->IsChannelRegistered(ChannelName))
+	{
+		UE_LOG(LogChatMessages, Verbose, TEXT("%s sent a message to unknown channel %s"), *PlayerName, *Channel.Left(64));
+		return;
+	}
+
+	if (ConsumeMessageToken())
+	{
+		SendStringToChannel(Input.Text, ChannelName);
+	}
+}
+
+// Subscribe to a channel (server-side only)
+void UChatComponent::SubscribeToChannel(const FName Channel)
+{
+	if (Channel.IsNone() || SubscribedChannels.Contains(Channel))
+	{
+		return;
+	}
+
+	SubscribedChannels.Add(Channel);
+	if (ChatManager)
+	{
+		ChatManager->SubscribeToChannel(this, Channel);
+	}
+}
+
+// Unsubscribe from a channel (server-side only)
+void UChatComponent::UnsubscribeFromChannel(const FName Channel)
+{
+	if (SubscribedChannels.Remove(Channel) > 0 && ChatManager)
+	{
+		ChatManager->UnsubscribeFromChannel(this, Channel);
 	}
 }
 
+// Check if subscribed to a channel
+bool UChatComponent::IsSubscribedToChannel(const FName Channel) const
+{
+	return SubscribedChannels.Contains(Channel);
+}
+
 // Send a chat message to all players on the server (called on the server)
-void UChatComponent::SendToAllStringToServer_Implementation(const FString& Input)
+void UChatComponent::SendToAllStringToServer_Implementation(const FChatEncodedString& Input)
 {
-	SendString(Input, true);
+	if (ConsumeMessageToken())
+	{
+		SendString(Input.Text, true);
+	}
 }
 
 // Set the player's name (can be called on the server or client)
@@ -139,7 +371,16 @@ void UChatComponent::SetPlayerName(const FString& Input)
 	else
 	{
 		// Server-side change of player name
-		PlayerName = Input;
+		const FString OldPlayerName = PlayerName;
+		// The name can come from a client, keep it to a sane length
+		PlayerName = Input.Left(NAME_SIZE - 1);
+		PlayerNameKey = FChatPlayerKey(PlayerName);
+
+		// Keep the name index of the chat manager in sync
+		if (ChatManager)
+		{
+			ChatManager->UpdatePlayerName(this, OldPlayerName);
+		}
 	}
 }
 
@@ -149,13 +390,49 @@ const FString& UChatComponent::GetPlayerName() const
 	return PlayerName;
 }
 
+// Keep the name key and the local sender name table in sync on clients
+void UChatComponent::OnRep_PlayerName()
+{
+	PlayerNameKey = FChatPlayerKey(PlayerName);
+
+	// The name can arrive before the player id, which is 0 until then (game sessions hand out ids from 256). Caching the
+	// name under it would give it to the wrong sender, the chat manager looks it up from the player states once the id is used
+	const APlayerState* PlayerState = Cast<APlayerState>(GetOwner());
+	if (!PlayerState || PlayerState->GetPlayerId() == 0)
+	{
+		return;
+	}
+
+	if (UChatManager* Manager = UChatManager::GetInstance(GetWorld()))
+	{
+		Manager->SetSenderName(GetSenderId(), PlayerName);
+	}
+}
+
+// Get the PlayerId of the owning player state
+int32 UChatComponent::GetSenderId() const
+{
+	const APlayerState* PlayerState = Cast<APlayerState>(GetOwner());
+	return PlayerState ? PlayerState->GetPlayerId() : INDEX_NONE;
+}
+
 // Notify that a message has been received (server-side or client-side)
-void UChatComponent::NotifyMessageReceived(uint8 TeamIndex, const FString& Input, const FString& SenderName)
+void UChatComponent::NotifyMessageReceived(uint8 TeamIndex, const FString& Input, const FString& SenderName,
+                                           const int32 SenderId, const FName Channel)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_NotifyMessageReceived);
+
 	if (GetOwnerRole() == ROLE_Authority)
 	{
-		// Server-side handling of received message
-		NotifyMessageReceivedOnClient(TeamIndex, Input, SenderName);
+		// Server-side handling of received message. Only remote owners need the message sent over the network
+		const AActor* Owner = GetOwner();
+		if (Owner && Owner->GetNetConnection())
+		{
+			// Player messages only carry the sender id, the client already knows the name
+			QueueMessage(FChatMessage(TeamIndex, Input, SenderId, SenderId == INDEX_NONE ? SenderName : FString(),
+			                          Channel),
+			             SenderId == INDEX_NONE ? AnnouncementDeliveryMode : ChatDeliveryMode);
+		}
 
 		// If this is a client, return after notifying the client, as the server doesn't need to notify itself
 		if (GetNetMode() == NM_Client)
@@ -164,84 +441,173 @@ void UChatComponent::NotifyMessageReceived(uint8 TeamIndex, const FString& Input
 		}
 	}
 
-	// If the sender is muted, ignore the message
-	if (MutedPlayers.Find(SenderName) != INDEX_NONE || ((MuteEnemies && TeamIndex != MyTeamIndex) && TeamIndex != 255))
+	// If the sender is muted, ignore the message. Channels other than local chat are joined on purpose, so enemies aren't muted there
+	const bool bMutesEnemies = MuteEnemies && (Channel.IsNone() || Channel == LocalChannel);
+	if ((MutedPlayers.Num() > 0 && MutedPlayers.Contains(FChatPlayerKey(SenderName))) || ((bMutesEnemies && TeamIndex != MyTeamIndex) && TeamIndex != 255))
 	{
-		UE_LOG(LogChatSystem, Log, TEXT("Received message from muted player %s. Ignoring the message"), *SenderName);
+		UE_LOG(LogChatMessages, Verbose, TEXT("Received message from muted player %s. Ignoring the message"), *SenderName);
 		return;
 	}
 
+	INC_DWORD_STAT(STAT_ChatSystem_MessagesReceived);
+	CSV_CUSTOM_STAT(ChatSystem, MessagesReceived, 1, ECsvCustomStatOp::Accumulate);
+
+	// Keep the message in the history of local players only, the server has no use for remote players' history
+	const AActor* Owner = GetOwner();
+	if (!IsRunningDedicatedServer() && !(Owner && Owner->GetNetConnection() && GetOwnerRole() == ROLE_Authority))
+	{
+		// Parse the rich text markup once here, UI reads the cached result instead of parsing again on every layout
+		const FChatHistoryEntry& Entry = History.Add(SenderName, TeamIndex, GetWorld()->GetTimeSeconds(), Input,
+		                                             FChatParsedMessage::Parse(Input), Channel);
+		OnHistoryEntryAdded.Broadcast(Entry);
+	}
+
 	// Broadcast the received message to listeners
-	OnReceiveMessage.Broadcast(SenderName, TeamIndex, MyTeamIndex, Input);
+	if (Channel.IsNone())
+	{
+		OnReceiveMessage.Broadcast(SenderName, TeamIndex, MyTeamIndex, Input);
+	}
+	else
+	{
+		OnReceiveChannelMessage.Broadcast(SenderName, Channel, TeamIndex, Input);
+	}
+}
+
+// Get the newest received messages
+TArray<FChatHistoryEntry> UChatComponent::GetLastMessages(const int32 Count) const
+{
+	TArray<FChatHistoryEntry> Result;
+	History.GetLast(Count, Result);
+	return Result;
+}
+
+// Get the received messages since a sequence number
+TArray<FChatHistoryEntry> UChatComponent::GetMessagesSince(const int32 Sequence) const
+{
+	TArray<FChatHistoryEntry> Result;
+	History.GetSince(Sequence, Result);
+	return Result;
+}
+
+// Get the newest received messages of a team
+TArray<FChatHistoryEntry> UChatComponent::GetTeamMessages(const uint8 TeamIndex, const int32 MaxCount) const
+{
+	TArray<FChatHistoryEntry> Result;
+	History.GetByTeam(TeamIndex, MaxCount, Result);
+	return Result;
 }
 
 // Make a server-wide announcement (broadcast the message to all players)
 void UChatComponent::MakeServerAnnouncement(const FString Message) const
 {
-	const TSubclassOf<APlayerController> Class = APlayerController::StaticClass();
-	for (TActorIterator<APlayerController> It(GetWorld(), Class); It; ++It)
+	UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+	if (!Manager)
 	{
-		UChatComponent* ChatComponent = GetChatComponent(*It);
-		if (ChatComponent)
-		{
-			// 255 is used as the TeamIndex for server-wide announcements
-			ChatComponent->NotifyMessageReceived(255, Message, ServerMessageSenderName);
-		}
+		return;
+	}
+
+	Manager->RecordReplayMessage(ServerMessageSenderName, 255, NAME_None, Message);
+	FChatAuditLog::Record(ServerMessageSenderName, 255, NAME_None, Message);
+
+	// Appended once to the replicated log instead of sending an RPC to every player
+	if (AChatAnnouncementLog* AnnouncementLog = Manager->GetOrSpawnAnnouncementLog())
+	{
+		AnnouncementLog->Append(Message, ServerMessageSenderName);
+		return;
+	}
+
+	for (UChatComponent* ChatComponent : Manager->GetAllComponents())
+	{
+		// 255 is used as the TeamIndex for server-wide announcements
+		ChatComponent->NotifyMessageReceived(255, Message, ServerMessageSenderName);
+	}
+}
+
+// Deliver an announcement from the announcement log (local players only)
+void UChatComponent::ReceiveAnnouncement(const AChatAnnouncementLog* Log, const int32 Sequence, const FChatMessage& Message)
+{
+	if (LastAnnouncementLog.Get() != Log)
+	{
+		LastAnnouncementLog = Log;
+		LastAnnouncementSequence = INDEX_NONE;
+	}
+
+	// The log can hand out the same announcement on replication and on catch up
+	if (Sequence <= LastAnnouncementSequence)
+	{
+		return;
 	}
+
+	LastAnnouncementSequence = Sequence;
+	NotifyMessageReceived(Message.TeamIndex, Message.Message, Message.SenderName, INDEX_NONE, Message.Channel);
+}
+
+// Fire the receive event of a remote player's component for an announcement (server-side only)
+void UChatComponent::NotifyAnnouncementOnServer(const FChatMessage& Message)
+{
+	if (MutedPlayers.Num() > 0 && MutedPlayers.Contains(FChatPlayerKey(Message.SenderName)))
+	{
+		return;
+	}
+
+	OnReceiveMessage.Broadcast(Message.SenderName, Message.TeamIndex, MyTeamIndex, Message.Message);
 }
 
 // Make a server announcement to a specific player
 void UChatComponent::MakeServerAnnouncementToPlayer(const FString Message, const FString Player) const
 {
-	const TSubclassOf<APlayerController> Class = APlayerController::StaticClass();
-	for (TActorIterator<APlayerController> It(GetWorld(), Class); It; ++It)
+	UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+	if (!Manager)
 	{
-		UChatComponent* ChatComponent = GetChatComponent(*It);
-		if (ChatComponent)
-		{
-			if (ChatComponent->PlayerName == Player)
-			{
-				// 255 is used as the TeamIndex for server-wide announcements
-				ChatComponent->NotifyMessageReceived(255, Message, ServerMessageSenderName);
-			}
-		}
+		return;
+	}
+
+	Manager->RecordReplayMessage(ServerMessageSenderName, 255, NAME_None, Message);
+	FChatAuditLog::Record(ServerMessageSenderName, 255, NAME_None, Message);
+
+	// Resolve the target through the name index instead of sweeping every player controller
+	for (UChatComponent* ChatComponent : Manager->GetComponentsByPlayerName(Player))
+	{
+		// 255 is used as the TeamIndex for server-wide announcements
+		ChatComponent->NotifyMessageReceived(255, Message, ServerMessageSenderName);
 	}
 }
 
 // Make a server announcement to a specific team
 void UChatComponent::MakeServerAnnouncementToTeam(FString Message, uint8 Team) const
 {
-	const TSubclassOf<APlayerController> Class = APlayerController::StaticClass();
-	for (TActorIterator<APlayerController> It(GetWorld(), Class); It; ++It)
+	UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+	if (!Manager)
 	{
-		UChatComponent* ChatComponent = GetChatComponent(*It);
-		if (ChatComponent)
-		{
-			if (ChatComponent->MyTeamIndex == Team)
-			{
-				// 255 is used as the TeamIndex for server-wide announcements
-				ChatComponent->NotifyMessageReceived(255, Message, ServerMessageSenderName);
-			}
-		}
+		return;
+	}
+
+	Manager->RecordReplayMessage(ServerMessageSenderName, 255, NAME_None, Message);
+	FChatAuditLog::Record(ServerMessageSenderName, 255, NAME_None, Message);
+
+	for (UChatComponent* ChatComponent : Manager->GetTeamMembers(Team))
+	{
+		// 255 is used as the TeamIndex for server-wide announcements
+		ChatComponent->NotifyMessageReceived(255, Message, ServerMessageSenderName);
 	}
 }
 
 // Mute a player (ignore messages from the player)
 void UChatComponent::MutePlayer(const FString& Player)
 {
-	MutedPlayers.AddUnique(Player);
+	AddPlayerToList(MutedPlayers, MutedPlayerNames, Player);
 }
 
 // Unmute a player (stop ignoring messages from the player)
 void UChatComponent::UnMutePlayer(const FString& Player)
 {
-	MutedPlayers.Remove(Player);
+	RemovePlayerFromList(MutedPlayers, MutedPlayerNames, Player);
 }
 
 // Get the list of muted players
 TArray<FString>& UChatComponent::GetMutedPlayers()
 {
-	return MutedPlayers;
+	return MutedPlayerNames;
 }
 
 // Set whether to mute messages from enemies
@@ -254,30 +620,191 @@ void UChatComponent::SetMuteEnemies(const bool Mute)
 void UChatComponent::BanPlayerFromChatAndPing(const FString& Player)
 {
 	UE_LOG(LogChatSystem, Log, TEXT("Banning %s"), *Player);
-	BannedPlayers.AddUnique(Player);
+	AddPlayerToList(BannedPlayers, BannedPlayerNames, Player);
 }
 
 // Unban a player from chat and ping system (server-side only)
 void UChatComponent::UnBanPlayerFromChatAndPing(const FString& Player)
 {
 	UE_LOG(LogChatSystem, Log, TEXT("UnBanning %s"), *Player);
-	BannedPlayers.Remove(Player);
+	RemovePlayerFromList(BannedPlayers, BannedPlayerNames, Player);
 }
 
 // Get the list of banned players
 TArray<FString>& UChatComponent::GetBannedPlayers()
 {
-	return BannedPlayers;
+	return BannedPlayerNames;
+}
+
+// Add a player to a mute or ban list and its name array
+void UChatComponent::AddPlayerToList(TSet<FChatPlayerKey>& Keys, TArray<FString>& Names, const FString& Player)
+{
+	bool bAlreadyInList = false;
+	Keys.Add(FChatPlayerKey(Player), &bAlreadyInList);
+	if (!bAlreadyInList)
+	{
+		Names.Add(Player);
+	}
+}
+
+// Remove a player from a mute or ban list and its name array
+void UChatComponent::RemovePlayerFromList(TSet<FChatPlayerKey>& Keys, TArray<FString>& Names, const FString& Player)
+{
+	if (Keys.Remove(FChatPlayerKey(Player)) > 0)
+	{
+		Names.RemoveAll([&Player](const FString& Name)
+		{
+			return Name.Equals(Player, ESearchCase::IgnoreCase);
+		});
+	}
+}
+
+// Queue a message for the owning client (server-side only)
+void UChatComponent::QueueMessage(const FChatMessage& Message, const EChatDeliveryMode DeliveryMode)
+{
+	if (!ChatManager)
+	{
+		// Without a manager nothing flushes the outbox, send right away
+		SendMessagesToClient({Message}, DeliveryMode != EChatDeliveryMode::Unreliable);
+		return;
+	}
+
+	// The chat manager flushes all outboxes at the end of the frame
+	if (Outbox.Num() == 0 && UnreliableOutbox.Num() == 0 && CappedOutbox.Num() == 0)
+	{
+		ChatManager->RequestFlush(this);
+	}
+
+	switch (DeliveryMode)
+	{
+	case EChatDeliveryMode::Unreliable:
+		UnreliableOutbox.Add(Message);
+		break;
+	case EChatDeliveryMode::ReliableCapped:
+		if (bDropHeldMessagesOnOverflow && CappedOutbox.Num() >= FMath::Max(1, MaxHeldMessages))
+		{
+			// Keep memory bounded for clients that stopped acknowledging
+			const int32 NumToDrop = CappedOutbox.Num() - FMath::Max(1, MaxHeldMessages) + 1;
+			CappedOutbox.RemoveAt(0, NumToDrop, false);
+			UE_LOG(LogChatMessages, Warning, TEXT("Dropped %d held chat messages for %s"), NumToDrop, *PlayerName);
+		}
+		CappedOutbox.Add(Message);
+		break;
+	default:
+		Outbox.Add(Message);
+		break;
+	}
+}
+
+// Check how many reliable bunches the owning connection hasn't acknowledged yet (server-side only)
+bool UChatComponent::IsReliableBufferSaturated() const
+{
+	AActor* Owner = GetOwner();
+	const UNetConnection* Connection = Owner ? Owner->GetNetConnection() : nullptr;
+	if (!Connection)
+	{
+		return false;
+	}
+
+	// RPCs of this component travel on the actor channel of its owner
+	const UActorChannel* Channel = Connection->FindActorChannelRef(Owner);
+	return Channel && Channel->NumOutRec >= MaxPendingReliableBunches;
+}
+
+// Notify that a batch of messages has been received on the client (server-side and client-side)
+void UChatComponent::NotifyMessagesReceivedOnClient_Implementation(const TArray<FChatMessage>& Messages)
+{
+	ReceiveMessages(Messages);
+}
+
+// Notify that a batch of unreliable messages has been received on the client (server-side and client-side)
+void UChatComponent::NotifyMessagesReceivedOnClientUnreliable_Implementation(const TArray<FChatMessage>& Messages)
+{
+	ReceiveMessages(Messages);
 }
 
-// Notify that a message has been received on the client (server-side and client-side)
-void UChatComponent::NotifyMessageReceivedOnClient_Implementation(uint8 TeamIndex, const FString& Input,
-                                                                  const FString& SenderName)
+// Deliver a batch of messages received from the server (client-side)
+void UChatComponent::ReceiveMessages(const TArray<FChatMessage>& Messages)
 {
 	if (GetOwnerRole() < ROLE_Authority)
 	{
-		// Forward the received message notification to the client-side function
-		NotifyMessageReceived(TeamIndex, Input, SenderName);
+		UChatManager* Manager = UChatManager::GetInstance(GetWorld());
+
+		// Forward each received message to the client-side function in the order they were sent
+		for (const FChatMessage& ChatMessage : Messages)
+		{
+			if (ChatMessage.SenderId == INDEX_NONE || !Manager)
+			{
+				NotifyMessageReceived(ChatMessage.TeamIndex, ChatMessage.Message, ChatMessage.SenderName, INDEX_NONE,
+				                      ChatMessage.Channel);
+			}
+			else
+			{
+				// Resolve the sender from the local name table
+				NotifyMessageReceived(ChatMessage.TeamIndex, ChatMessage.Message,
+				                      Manager->ResolveSenderName(ChatMessage.SenderId), ChatMessage.SenderId,
+				                      ChatMessage.Channel);
+			}
+		}
+	}
+}
+
+// Send the queued messages to the owning client, one RPC per delivery mode
+void UChatComponent::FlushOutbox()
+{
+	if (Outbox.Num() > 0)
+	{
+		SendMessagesToClient(Outbox, true);
+		Outbox.Reset();
+	}
+
+	if (UnreliableOutbox.Num() > 0)
+	{
+		SendMessagesToClient(UnreliableOutbox, false);
+		UnreliableOutbox.Reset();
+	}
+
+	if (CappedOutbox.Num() == 0)
+	{
+		return;
+	}
+
+	// Hold capped messages while the connection is backed up
+	if (IsReliableBufferSaturated())
+	{
+		ChatManager->RequestFlush(this);
+		return;
+	}
+
+	const int32 NumToSend = FMath::Min(CappedOutbox.Num(), FMath::Max(1, MaxCappedMessagesPerFlush));
+	if (NumToSend == CappedOutbox.Num())
+	{
+		SendMessagesToClient(CappedOutbox, true);
+		CappedOutbox.Reset();
+		return;
+	}
+
+	// Drain the rest over the next frames
+	SendMessagesToClient(TArray<FChatMessage>(CappedOutbox.GetData(), NumToSend), true);
+	CappedOutbox.RemoveAt(0, NumToSend, false);
+	ChatManager->RequestFlush(this);
+}
+
+// Call the client RPC of a delivery mode with a batch of messages (server-side only)
+void UChatComponent::SendMessagesToClient(const TArray<FChatMessage>& Messages, const bool bReliable)
+{
+	INC_DWORD_STAT(STAT_ChatSystem_ClientMessageRpcs);
+	CSV_CUSTOM_STAT(ChatSystem, ClientMessageRpcs, 1, ECsvCustomStatOp::Accumulate);
+	++FChatSystemCounters::ClientMessageRpcs;
+	FChatSystemCounters::ClientMessagesSent += Messages.Num();
+
+	if (bReliable)
+	{
+		NotifyMessagesReceivedOnClient(Messages);
+	}
+	else
+	{
+		NotifyMessagesReceivedOnClientUnreliable(Messages);
 	}
 }
 
@@ -311,13 +838,51 @@ void UChatComponent::SetPlayerNameOnServer_Implementation(const FString& Input)
 void UChatComponent::SetTeamIndexOnServer_Implementation(const uint8 Index)
 {
 	UE_LOG(LogChatSystem,Log,TEXT("Player %s joined team %d"),*GetPlayerName(),Index)
+	const uint8 OldTeamIndex = MyTeamIndex;
 	MyTeamIndex = Index;
+
+	// Keep the team buckets of the chat manager in sync
+	if (ChatManager)
+	{
+		ChatManager->UpdateTeam(this, OldTeamIndex);
+	}
 }
 
 // Send a chat message to a specific player on the server (called on the server)
-void UChatComponent::SendStringOnServer_Implementation(const FString& Input)
+void UChatComponent::SendStringOnServer_Implementation(const FChatEncodedString& Input)
+{
+	if (ConsumeMessageToken())
+	{
+		SendString(Input.Text, false);
+	}
+}
+
+// Check the message token bucket of the owning client (called on the server)
+bool UChatComponent::ConsumeMessageToken()
 {
-	SendString(Input, false);
+	if (MessageBucket.TryConsume(GetWorld()->GetRealTimeSeconds(), MessagesPerSecond, MessageBurstSize))
+	{
+		RateLimitStats.AcceptedMessages++;
+		bNotifiedRateLimit = false;
+		return true;
+	}
+
+	RateLimitStats.RejectedMessages++;
+	UE_LOG(LogChatMessages, Verbose, TEXT("Rate limited message from %s"), *PlayerName);
+
+	// Only tell the player once per rejected burst so the reply can't be used to flood the connection
+	if (!bNotifiedRateLimit)
+	{
+		bNotifiedRateLimit = true;
+		NotifyMessageReceived(255, RateLimitMessage, ServerMessageSenderName);
+	}
+	return false;
+}
+
+// Get the rate limiter counters of this player
+const FChatRateLimitStats& UChatComponent::GetRateLimitStats() const
+{
+	return RateLimitStats;
 }
 
 // Replication function for lifetime properties
@@ -332,15 +897,19 @@ void UChatComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 // Spawn a ping marker at a location (server-side and client-side)
 void UChatComponent::SpawnPingAtLocation(FVector Location, TSubclassOf<APingActor> PingClass)
 {
-	// Check if the ping timer allows placing a new ping
-	if (PingTimer > 0)
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_SpawnPingAtLocation);
+	CSV_SCOPED_TIMING_STAT(ChatSystem, SpawnPingAtLocation);
+
+	// Check if enough time has passed since the last ping
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastPingTime < MinTimeBetweenPings)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Ignoring ping because the timer is not zero"));
+		UE_LOG(LogChatPing, Verbose, TEXT("Ignoring ping because the timer is not zero"));
 		return;
 	}
 
 	// Reset the ping timer
-	PingTimer = MinTimeBetweenPings;
+	LastPingTime = Now;
 
 	// If this is not the server, forward the ping request to the server for processing
 	if (GetOwnerRole() != ROLE_Authority)
@@ -351,43 +920,49 @@ void UChatComponent::SpawnPingAtLocation(FVector Location, TSubclassOf<APingActo
 	{
 		// Server-side handling of ping placement
 
-		// Get the number of pings of the specified class already spawned
-		int32 NumPingsOfClass = 0;
-		for (AActor* Actor : SpawnedPings)
+		// Pings of this class the player still has in the world, oldest first
+		FPingRing& Ring = OwnedPings.FindOrAdd(TObjectKey<UClass>(PingClass.Get()));
+		if (Ring.Capacity() == 0)
 		{
-			const APingActor* PingActor = Cast<APingActor>(Actor);
-			if (PingActor && PingActor->IsA(PingClass))
-			{
-				NumPingsOfClass++;
-			}
+			Ring.Reset(Cast<APingActor>(PingClass->ClassDefaultObject)->MaxNumberOfPings);
 		}
 
-		// Check if the number of pings of the specified class exceeds the maximum allowed
-		if (NumPingsOfClass >= Cast<APingActor>(PingClass->ClassDefaultObject)->MaxNumberOfPings)
+		// Remove the oldest ping of the specified class to make room for a new one
+		if (Ring.IsFull())
 		{
-			// Remove the oldest ping of the specified class to make room for a new one
-			for (int32 Index = 0; Index < SpawnedPings.Num(); Index++)
+			APingActor* Oldest = Ring.Pop();
+			if (IsValid(Oldest) && Oldest->IsPingActive())
 			{
-				const APingActor* PingActor = Cast<APingActor>(SpawnedPings[Index]);
-				if (PingActor && PingActor->IsA(PingClass))
-				{
-					// Destroy the oldest ping and remove it from the SpawnedPings array
-					Cast<APingActor>(SpawnedPings[Index])->DestroyOnServer();
-					SpawnedPings.RemoveAt(Index);
-					break;
-				}
+				Oldest->DestroyOnServer();
 			}
 		}
 
-		// Spawn a new ping actor at the specified location and add it to the SpawnedPings array
-		APingActor* Actor = GetWorld()->SpawnActorDeferred<APingActor>(PingClass.Get(), FTransform(Location),
-		                                                               GetOwner(), nullptr,
-		                                                               ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
-		Actor->OwningPlayerName = PlayerName;
-		Actor->TeamIndex = MyTeamIndex;
-		UGameplayStatics::FinishSpawningActor(Actor, FTransform(Location));
+		// Reuse a pooled ping of this class or spawn a new one
+		APingActor* Actor = nullptr;
+		if (UPingManager* PingManager = UPingManager::GetInstance(GetWorld()))
+		{
+			Actor = PingManager->AcquirePing(PingClass, Location, GetOwner(), PlayerName, MyTeamIndex);
+		}
+		if (!Actor)
+		{
+			return;
+		}
+
+		Ring.Push(Actor);
 
-		SpawnedPings.Add(Actor);
+		if (UChatManager* Manager = UChatManager::GetInstance(GetWorld()))
+		{
+			Manager->RecordReplayPing(PlayerName, MyTeamIndex, Location);
+		}
+	}
+}
+
+// Forget a ping that ended so it no longer counts against MaxNumberOfPings (server-side)
+void UChatComponent::OnPingEnded(const APingActor* Ping)
+{
+	if (FPingRing* Ring = OwnedPings.Find(TObjectKey<UClass>(Ping->GetClass())))
+	{
+		Ring->Remove(Ping);
 	}
 }
 
@@ -417,26 +992,50 @@ void UChatComponent::SpawnPingAtScreenLocation(TSubclassOf<APingActor> PingClass
 // Mute a player's pings (ignore their pings)
 void UChatComponent::MutePlayerPings(const FString& Player)
 {
-	PingMutedPlayers.AddUnique(Player);
+	AddPlayerToList(PingMutedPlayers, PingMutedPlayerNames, Player);
+	if (ChatManager)
+	{
+		ChatManager->InvalidatePingRelevancy();
+	}
 }
 
 // Unmute a player's pings (stop ignoring their pings)
 void UChatComponent::UnMutePlayerPings(const FString& Player)
 {
-	PingMutedPlayers.Remove(Player);
+	RemovePlayerFromList(PingMutedPlayers, PingMutedPlayerNames, Player);
+	if (ChatManager)
+	{
+		ChatManager->InvalidatePingRelevancy();
+	}
 }
 
 // Get the list of ping-muted players
 const TArray<FString>& UChatComponent::GetPingMutedPlayers() const
 {
-	return PingMutedPlayers;
+	return PingMutedPlayerNames;
+}
+
+// Check if pings of a player are muted
+bool UChatComponent::IsPlayerPingMuted(const FChatPlayerKey& PlayerKey) const
+{
+	return PingMutedPlayers.Num() > 0 && PingMutedPlayers.Contains(PlayerKey);
 }
 
 // Spawn a ping marker at a location on the server (called on the server)
 void UChatComponent::SpawnPingAtLocationServer_Implementation(FVector Location, TSubclassOf<APingActor> PingClass)
 {
-	if (!BannedPlayers.Contains(PlayerName))
+	if (BannedPlayers.Contains(PlayerNameKey))
+	{
+		return;
+	}
+
+	// Authoritative rate limit, the client side ping timer can't be trusted
+	if (!PingBucket.TryConsume(GetWorld()->GetRealTimeSeconds(), PingsPerSecond, PingBurstSize))
 	{
-		SpawnPingAtLocation(Location, PingClass);
+		RateLimitStats.RejectedPings++;
+		return;
 	}
+	RateLimitStats.AcceptedPings++;
+
+	SpawnPingAtLocation(Location, PingClass);
 }
@@ -2,6 +2,7 @@
 
 #include "Components/TitanWidgetComponent.h"
 #include "Slate/STitanWidgetScreenLayer.h"
+#include "ChatSystemStats.h"
 
 #include "Components/WidgetComponent.h"
 #include "Engine/GameInstance.h"
@@ -1126,6 +1127,9 @@ void UTitanWidgetComponent::OnUnregister()
 	}
 #endif
 
+	// Counted again by UpdateRenderTarget if the component is registered again
+	SetTrackedRenderTargetMemory(0);
+
 	Super::OnUnregister();
 }
 
@@ -1203,6 +1207,8 @@ void UTitanWidgetComponent::UnregisterWindow()
 
 void UTitanWidgetComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_WidgetComponentTick);
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 #if !UE_SERVER
@@ -1329,6 +1335,9 @@ bool UTitanWidgetComponent::ShouldDrawWidget() const
 
 void UTitanWidgetComponent::DrawWidgetToRenderTarget(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_DrawWidgetToRenderTarget);
+	CSV_SCOPED_TIMING_STAT(ChatSystem, DrawWidgetToRenderTarget);
+
 	if ( GUsingNullRHI )
 	{
 		return;
@@ -1424,6 +1433,16 @@ double UTitanWidgetComponent::GetCurrentTime() const
 	return (TimingPolicy == EWidgetTimingPolicy::RealTime) ? FApp::GetCurrentTime() : static_cast<double>(GetWorld()->GetTimeSeconds());
 }
 
+void UTitanWidgetComponent::OnHiddenInGameChanged()
+{
+	Super::OnHiddenInGameChanged();
+
+	if (bHiddenInGame && bAddedToScreen)
+	{
+		RemoveWidgetFromScreen();
+	}
+}
+
 void UTitanWidgetComponent::RemoveWidgetFromScreen()
 {
 #if !UE_SERVER
@@ -1840,9 +1859,24 @@ void UTitanWidgetComponent::UpdateRenderTarget(FIntPoint DesiredRenderTargetSize
 		{
 			MarkRenderStateDirty();
 		}
+
+		SetTrackedRenderTargetMemory(static_cast<int64>(RenderTarget->SizeX) * RenderTarget->SizeY * GPixelFormats[RenderTarget->GetFormat()].BlockBytes);
 	}
 }
 
+void UTitanWidgetComponent::SetTrackedRenderTargetMemory(int64 Bytes)
+{
+	if ( Bytes == TrackedRenderTargetMemory )
+	{
+		return;
+	}
+
+	DEC_MEMORY_STAT_BY(STAT_ChatSystem_RenderTargetMemory, TrackedRenderTargetMemory);
+	INC_MEMORY_STAT_BY(STAT_ChatSystem_RenderTargetMemory, Bytes);
+	FChatSystemCounters::RenderTargetBytes += Bytes - TrackedRenderTargetMemory;
+	TrackedRenderTargetMemory = Bytes;
+}
+
 void UTitanWidgetComponent::UpdateBodySetup( bool bDrawSizeChanged )
 {
 	if (Space == EWidgetSpace::Screen)
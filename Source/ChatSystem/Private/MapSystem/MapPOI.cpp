@@ -5,6 +5,7 @@
 
 #include "Engine/World.h"
 #include "MapSystem/POIManager.h"
+#include "ChatSystemStats.h"
 
 // Sets default values for this component's properties
 UMapPOI::UMapPOI()
@@ -23,9 +24,10 @@ void UMapPOI::BeginPlay()
 	Super::BeginPlay();
 
 	POIManager = GetWorld()->GetSubsystem<UPOIManager>();
-	if (POIManager)
+	if (POIManager && !bAddedToManager)
 	{
 		POIManager->AddPoi(this);
+		bAddedToManager = true;
 	}
 }
 
@@ -33,9 +35,10 @@ void UMapPOI::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	if (POIManager)
+	if (POIManager && bAddedToManager)
 	{
 		POIManager->RemovePoi(this);
+		bAddedToManager = false;
 	}
 	for (auto it = POIWidgets.CreateIterator(); it; ++it)
 	{
@@ -43,6 +46,37 @@ void UMapPOI::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	}
 }
 
+void UMapPOI::Activate(bool bReset)
+{
+	Super::Activate(bReset);
+
+	if (POIManager && !bAddedToManager)
+	{
+		POIManager->AddPoi(this);
+		bAddedToManager = true;
+	}
+}
+
+void UMapPOI::Deactivate()
+{
+	Super::Deactivate();
+
+	if (POIManager && bAddedToManager)
+	{
+		POIManager->RemovePoi(this);
+		bAddedToManager = false;
+	}
+	// Widgets are created again by the maps once the POI is back
+	for (auto it = POIWidgets.CreateIterator(); it; ++it)
+	{
+		if (it.Value())
+		{
+			it.Value()->RemoveFromParent();
+		}
+	}
+	POIWidgets.Empty();
+}
+
 
 // Called every frame
 void UMapPOI::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -68,5 +102,6 @@ UUserWidget* UMapPOI::GetWidgetFor(UUserWidget* MapWidget)
 
 void UMapPOI::CallOnWidgetUpdate(UUserWidget* InWidget)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_POIUpdate);
 	OnWidgetUpdate.Broadcast(InWidget);
 }
@@ -2,20 +2,21 @@
 
 
 #include "PingSystem/PingActor.h"
-#if WITH_EDITOR
-#include "Editor.h"
-#endif
+#include "ChatSystemStats.h"
+#include "ChatSystem/ChatManager.h"
 #include "Components/ChatComponent.h"
 #include "Components/TitanWidgetComponent.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "MapSystem/MapPOI.h"
 #include "Net/UnrealNetwork.h"
+#include "PingSystem/PingManager.h"
 
 // Sets default values
 APingActor::APingActor(): LifeTime(3.f), MaxNumberOfPings(1)
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Pings don't need to tick, the ping manager drives their lifetime and destroy polling
+	// Blueprints implementing Event Tick still tick, the blueprint compiler turns bCanEverTick back on for them
+	PrimaryActorTick.bCanEverTick = false;
 
 	SphereComponent = CreateDefaultSubobject<USphereComponent>("Sphere");
 	SetRootComponent(SphereComponent);
@@ -25,6 +26,8 @@ APingActor::APingActor(): LifeTime(3.f), MaxNumberOfPings(1)
 	TitanWidgetComponent->SetupAttachment(RootComponent);
 	TitanWidgetComponent->SetWidgetSpace(EWidgetSpace::Screen);
 	bReplicates = true;
+	// Pooled pings move when they are reused
+	SetReplicatingMovement(true);
 }
 
 // Called when the game starts or when spawned
@@ -32,48 +35,218 @@ void APingActor::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (LifeTime > 0 && GetLocalRole() == ROLE_Authority)
+	ChatManager = UChatManager::GetInstance(GetWorld());
+
+	// Late joiners can receive a ping that is waiting in the pool
+	SetCountedActive(ActivationState.bActive);
+	if (!ActivationState.bActive)
+	{
+		SetPingVisible(false);
+	}
+	else if (GetLocalRole() == ROLE_Authority)
+	{
+		StartLifeTime();
+	}
+}
+
+// Called when the ping is removed from the world
+void APingActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetCountedActive(false);
+	StopLifeTime();
+	if (GetLocalRole() == ROLE_Authority)
 	{
-		GetWorld()->GetTimerManager().SetTimer(TimerHandle, FTimerDelegate::CreateLambda(([&]
+		NotifyOwnerPingEnded();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APingActor::ActivatePing(const FVector& Location, AActor* NewOwner, const FString& InOwningPlayerName,
+                              const uint8 InTeamIndex)
+{
+	SetOwner(NewOwner);
+	SetActorLocation(Location, false, nullptr, ETeleportType::ResetPhysics);
+	OwningPlayerName = InOwningPlayerName;
+	TeamIndex = InTeamIndex;
+	PingPendingDestroy = false;
+	RelevancyCache.Reset();
+
+	ActivationState.bActive = true;
+	ActivationState.Activation++;
+
+	// Wake the ping up so the new state reaches clients right away
+	SetNetDormancy(DORM_Awake);
+	FlushNetDormancy();
+	ForceNetUpdate();
+
+	SetPingVisible(true);
+	SetCountedActive(true);
+	PingActivated();
+	StartLifeTime();
+}
+
+void APingActor::DeactivatePing()
+{
+	StopLifeTime();
+	PingPendingDestroy = false;
+	ActivationState.bActive = false;
+	SetPingVisible(false);
+	SetCountedActive(false);
+
+	// Dormant pings cost nothing to replicate, pending changes are sent before the channel goes dormant
+	SetNetDormancy(DORM_DormantAll);
+}
+
+void APingActor::OnRep_ActivationState(const FPingActivationState& PreviousState)
+{
+	if (ActivationState.bActive)
+	{
+		if (!PreviousState.bActive || PreviousState.Activation != ActivationState.Activation)
 		{
-			if(!UKismetSystemLibrary::IsValid(this))
+			PingPendingDestroy = false;
+			SetPingVisible(true);
+			SetCountedActive(true);
+			if (HasActorBegunPlay())
 			{
-				DestroyOnServer();
+				PingActivated();
 			}
-		})), LifeTime, false);
+		}
+	}
+	else if (!HasActorBegunPlay())
+	{
+		// Received straight from the pool, nothing to animate
+		SetPingVisible(false);
+		SetCountedActive(false);
+	}
+	else if (PreviousState.bActive)
+	{
+		BeginPingEnd();
 	}
+}
 
-#if WITH_EDITOR
-	FEditorDelegates::PrePIEEnded.AddLambda([&](bool in)
+void APingActor::StartLifeTime()
+{
+	if (LifeTime > 0)
 	{
-		if (this)
+		if (UPingManager* PingManager = UPingManager::GetInstance(GetWorld()))
 		{
-			if (TimerHandle.IsValid())
-			{
-				TimerHandle.Invalidate();
-			}
+			PingManager->ScheduleExpiration(this, LifeTime);
+		}
+	}
+}
+
+void APingActor::StopLifeTime()
+{
+	ExpireTime = -1.0;
+}
+
+void APingActor::OnLifeTimeExpired()
+{
+	DestroyOnServer();
+}
+
+void APingActor::BeginPingEnd()
+{
+	PingBeginDestroy();
+	SetPendingDestroy();
+
+	if (AutoDestroyAttachedPOI)
+	{
+		// Pooled pings keep their POI and only take it off the maps until they are reused
+		if (UActorComponent* Component = GetComponentByClass(UMapPOI::StaticClass()))
+		{
+			Component->Deactivate();
+		}
+	}
+}
+
+void APingActor::SetPendingDestroy()
+{
+	PingPendingDestroy = true;
+	if (UPingManager* PingManager = UPingManager::GetInstance(GetWorld()))
+	{
+		PingManager->AddPendingDestroy(this);
+	}
+}
+
+void APingActor::SetPingVisible(const bool bVisible)
+{
+	SetActorHiddenInGame(!bVisible);
+	SetActorEnableCollision(bVisible);
+	TitanWidgetComponent->SetHiddenInGame(!bVisible);
+	TitanWidgetComponent->SetComponentTickEnabled(bVisible);
+
+	if (UActorComponent* Component = GetComponentByClass(UMapPOI::StaticClass()))
+	{
+		if (bVisible)
+		{
+			Component->Activate(true);
+		}
+		else
+		{
+			Component->Deactivate();
 		}
-	});
+	}
+}
 
-#endif
+void APingActor::SetCountedActive(const bool bActive)
+{
+	if (bActive == bCountedActive)
+	{
+		return;
+	}
+
+	bCountedActive = bActive;
+	if (bActive)
+	{
+		INC_DWORD_STAT(STAT_ChatSystem_ActivePings);
+		++FChatSystemCounters::ActivePings;
+	}
+	else
+	{
+		DEC_DWORD_STAT(STAT_ChatSystem_ActivePings);
+		--FChatSystemCounters::ActivePings;
+	}
+}
+
+void APingActor::NotifyOwnerPingEnded()
+{
+	if (UChatComponent* OwningChatComponent = GetOwningChatComponent())
+	{
+		OwningChatComponent->OnPingEnded(this);
+	}
 }
 
 bool APingActor::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_ChatSystem_PingIsNetRelevantFor);
+
 	if (!IsGlobalPing)
 	{
 		if (const APlayerController* PC = Cast<APlayerController>(RealViewer))
 		{
-			if (const UChatComponent* TargetChatComponent = Cast<UChatComponent>(
-				PC->GetPlayerState<APlayerState>()->GetComponentByClass(UChatComponent::StaticClass())))
+			if (!ChatManager)
 			{
-				if (const UChatComponent* OwningChatComponent = GetOwningChatComponent())
+				if (!IsVisibleToPlayer(PC))
 				{
-					if (OwningChatComponent->GetTeamIndex() != TargetChatComponent->GetTeamIndex() ||
-						TargetChatComponent->GetPingMutedPlayers().Contains(OwningChatComponent->GetPlayerName()))
-					{
-						return false;
-					}
+					return false;
+				}
+			}
+			else
+			{
+				// Runs for every connection on every replication pass, the result only changes with teams and mutes
+				if (RelevancyCacheEpoch != ChatManager->GetPingRelevancyEpoch())
+				{
+					RelevancyCache.Reset();
+					RelevancyCacheEpoch = ChatManager->GetPingRelevancyEpoch();
+				}
+
+				const bool* bCachedVisible = RelevancyCache.Find(PC);
+				const bool bVisible = bCachedVisible ? *bCachedVisible : RelevancyCache.Add(PC, IsVisibleToPlayer(PC));
+				if (!bVisible)
+				{
+					return false;
 				}
 			}
 		}
@@ -82,19 +255,55 @@ bool APingActor::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTa
 	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
 }
 
-// Called every frame
-void APingActor::Tick(float DeltaTime)
+bool APingActor::IsVisibleToPlayer(const APlayerController* Viewer) const
 {
-	Super::Tick(DeltaTime);
+	const APlayerState* ViewerPlayerState = Viewer->GetPlayerState<APlayerState>();
+	if (!ViewerPlayerState)
+	{
+		return true;
+	}
 
+	if (const UChatComponent* TargetChatComponent = Cast<UChatComponent>(
+		ViewerPlayerState->GetComponentByClass(UChatComponent::StaticClass())))
+	{
+		if (const UChatComponent* OwningChatComponent = GetOwningChatComponent())
+		{
+			if (OwningChatComponent->GetTeamIndex() != TargetChatComponent->GetTeamIndex() ||
+				TargetChatComponent->IsPlayerPingMuted(OwningChatComponent->GetPlayerNameKey()))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
 
-	if (PingPendingDestroy)
+// Called by the ping manager once IsPingReadyToDestroy returned true
+void APingActor::FinishPingEnd()
+{
+	PingPendingDestroy = false;
+	if (GetTearOff() || !bPoolable)
+	{
+		Destroy();
+	}
+	else if (GetLocalRole() == ROLE_Authority)
 	{
-		if (IsPingReadyToDestroy())
+		UPingManager* PingManager = UPingManager::GetInstance(GetWorld());
+		if (PingManager)
+		{
+			PingManager->ReleasePing(this);
+		}
+		else
 		{
 			Destroy();
 		}
 	}
+	else
+	{
+		// The server owns the pooled actor, clients only hide it and stop counting it
+		SetPingVisible(false);
+		SetCountedActive(false);
+	}
 }
 
 bool APingActor::IsPingReadyToDestroy_Implementation()
@@ -123,7 +332,7 @@ UChatComponent* APingActor::GetOwningChatComponent() const
 void APingActor::TornOff()
 {
 	PingBeginDestroy();
-	PingPendingDestroy = true;
+	SetPendingDestroy();
 
 	if(AutoDestroyAttachedPOI)
 	{
@@ -138,10 +347,27 @@ void APingActor::TornOff()
 
 void APingActor::DestroyOnServer_Implementation()
 {
-	TearOff();
-	PingBeginDestroy();
-	PingPendingDestroy = true;
-	
+	NotifyOwnerPingEnded();
+
+	if (!bPoolable)
+	{
+		TearOff();
+		PingBeginDestroy();
+		SetPendingDestroy();
+		return;
+	}
+
+	if (!ActivationState.bActive)
+	{
+		return;
+	}
+
+	// Clients start their end of the ping when the state replicates
+	StopLifeTime();
+	ActivationState.bActive = false;
+	ForceNetUpdate();
+	SetCountedActive(false);
+	BeginPingEnd();
 }
 
 
@@ -150,4 +376,5 @@ void APingActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifeti
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 	DOREPLIFETIME(APingActor, OwningPlayerName);
 	DOREPLIFETIME(APingActor, TeamIndex);
+	DOREPLIFETIME(APingActor, ActivationState);
 }
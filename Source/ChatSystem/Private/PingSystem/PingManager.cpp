@@ -0,0 +1,148 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "PingSystem/PingManager.h"
+
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "PingSystem/PingActor.h"
+
+UPingManager* UPingManager::GetInstance(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UPingManager>() : nullptr;
+}
+
+void UPingManager::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UPingManager::OnWorldPostActorTick);
+}
+
+void UPingManager::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+APingActor* UPingManager::AcquirePing(const TSubclassOf<APingActor> PingClass, const FVector& Location, AActor* Owner,
+                                      const FString& OwningPlayerName, const uint8 TeamIndex)
+{
+	UWorld* World = GetWorld();
+	if (!World || !PingClass)
+	{
+		return nullptr;
+	}
+
+	APingActor* Ping = nullptr;
+	if (FPingActorPool* Pool = Pools.Find(PingClass.Get()))
+	{
+		// Pooled actors can be destroyed from outside, for example by streaming out their level
+		while (!Ping && Pool->Inactive.Num() > 0)
+		{
+			APingActor* Candidate = Pool->Inactive.Pop(false);
+			if (IsValid(Candidate))
+			{
+				Ping = Candidate;
+			}
+		}
+	}
+
+	if (!Ping)
+	{
+		Ping = World->SpawnActorDeferred<APingActor>(PingClass.Get(), FTransform(Location), Owner, nullptr,
+		                                              ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		Ping->OwningPlayerName = OwningPlayerName;
+		Ping->TeamIndex = TeamIndex;
+		UGameplayStatics::FinishSpawningActor(Ping, FTransform(Location));
+		return Ping;
+	}
+
+	Ping->ActivatePing(Location, Owner, OwningPlayerName, TeamIndex);
+	OnPingReactivated.Broadcast(Ping);
+	return Ping;
+}
+
+void UPingManager::ReleasePing(APingActor* Ping)
+{
+	if (!IsValid(Ping))
+	{
+		return;
+	}
+
+	FPingActorPool& Pool = Pools.FindOrAdd(Ping->GetClass());
+	if (!Ping->bPoolable || Pool.Inactive.Num() >= Ping->MaxPooledPings)
+	{
+		Ping->Destroy();
+		return;
+	}
+
+	Ping->DeactivatePing();
+	Pool.Inactive.Add(Ping);
+}
+
+int32 UPingManager::GetNumPooled(const TSubclassOf<APingActor> PingClass) const
+{
+	const FPingActorPool* Pool = Pools.Find(PingClass.Get());
+	return Pool ? Pool->Inactive.Num() : 0;
+}
+
+void UPingManager::ScheduleExpiration(APingActor* Ping, const float LifeTime)
+{
+	Ping->ExpireTime = GetWorld()->GetTimeSeconds() + LifeTime;
+	Expirations.HeapPush(FPingExpiration{Ping, Ping->ExpireTime});
+}
+
+void UPingManager::AddPendingDestroy(APingActor* Ping)
+{
+	PendingDestroy.Add(Ping);
+}
+
+void UPingManager::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	const double Now = World->GetTimeSeconds();
+	while (Expirations.Num() > 0 && Expirations.HeapTop().ExpireTime <= Now)
+	{
+		FPingExpiration Expiration;
+		Expirations.HeapPop(Expiration, false);
+
+		APingActor* Ping = Expiration.Ping.Get();
+		if (IsValid(Ping) && Ping->ExpireTime == Expiration.ExpireTime)
+		{
+			Ping->ExpireTime = -1.0;
+			Ping->OnLifeTimeExpired();
+		}
+	}
+
+	if (PendingDestroy.Num() == 0)
+	{
+		return;
+	}
+
+	// Swap out the list first, ending a ping can start the end of another one
+	TSet<TWeakObjectPtr<APingActor>> ToPoll = MoveTemp(PendingDestroy);
+	PendingDestroy.Reset();
+	for (const TWeakObjectPtr<APingActor>& WeakPing : ToPoll)
+	{
+		APingActor* Ping = WeakPing.Get();
+		if (!IsValid(Ping) || !Ping->PingPendingDestroy)
+		{
+			continue;
+		}
+
+		if (Ping->IsPingReadyToDestroy())
+		{
+			Ping->FinishPingEnd();
+		}
+		else
+		{
+			PendingDestroy.Add(Ping);
+		}
+	}
+}
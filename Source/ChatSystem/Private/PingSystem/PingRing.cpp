@@ -0,0 +1,61 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "PingSystem/PingRing.h"
+#include "PingSystem/PingActor.h"
+
+void FPingRing::Reset(const int32 Capacity)
+{
+	Slots.Reset();
+	Slots.SetNum(FMath::Max(Capacity, 1));
+	Head = 0;
+	Count = 0;
+}
+
+void FPingRing::Push(APingActor* Ping)
+{
+	check(!IsFull());
+	Slots[(Head + Count) % Slots.Num()] = Ping;
+	Count++;
+}
+
+APingActor* FPingRing::Pop()
+{
+	if (Count == 0)
+	{
+		return nullptr;
+	}
+
+	APingActor* Oldest = Slots[Head].Get();
+	Slots[Head].Reset();
+	Head = (Head + 1) % Slots.Num();
+	Count--;
+	return Oldest;
+}
+
+bool FPingRing::Remove(const APingActor* Ping)
+{
+	for (int32 Offset = 0; Offset < Count; Offset++)
+	{
+		if (Slots[(Head + Offset) % Slots.Num()].Get() != Ping)
+		{
+			continue;
+		}
+
+		if (Offset == 0)
+		{
+			Pop();
+			return true;
+		}
+
+		// Close the gap by moving the newer entries one slot towards the head
+		for (int32 Index = Offset; Index < Count - 1; Index++)
+		{
+			Slots[(Head + Index) % Slots.Num()] = Slots[(Head + Index + 1) % Slots.Num()];
+		}
+		Count--;
+		Slots[(Head + Count) % Slots.Num()].Reset();
+		return true;
+	}
+	return false;
+}
@@ -6,6 +6,7 @@
 
 
 #include "RadialPanelSlot.h"
+#include "ChatSystemLog.h"
 #include "Blueprint/SlateBlueprintLibrary.h"
 #include "Components/Button.h"
 #include "Components/CanvasPanelSlot.h"
@@ -222,7 +223,7 @@ int URadialMenu::GetElementUnderSelector(UWidget*& Widget)
 void URadialMenu::SetSelectorVisibility(const bool In)
 {
 	
-	UE_LOG(LogTemp,Log,TEXT("Visiblity %d"),In)
+	UE_LOG(LogChatUI,VeryVerbose,TEXT("Visiblity %d"),In)
 	if (MaterialInstance)
 	{
 		MaterialInstance->SetVectorParameterValue(FName("ForeGround"),  In ? SelectorColor : BackgroundColor);
@@ -0,0 +1,109 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#include "Slate/SChatMessageList.h"
+
+#include "ChatSystem/ChatRichText.h"
+#include "Styling/CoreStyle.h"
+#include "Widgets/Text/SRichTextBlock.h"
+
+void SChatMessageList::Construct(const FArguments& InArgs)
+{
+	MaxMessages = FMath::Max(1, InArgs._MaxMessages);
+	bAutoScroll = InArgs._AutoScroll;
+	TextStyle = InArgs._TextStyle;
+	DecoratorStyleSet = InArgs._DecoratorStyleSet;
+
+	ChildSlot
+	[
+		SAssignNew(ListView, SListView<FChatItem>)
+		.ListItemsSource(&Items)
+		.SelectionMode(ESelectionMode::None)
+		.OnGenerateRow(this, &SChatMessageList::OnGenerateRow)
+	];
+}
+
+void SChatMessageList::AddMessage(const FChatHistoryEntry& Entry)
+{
+	const bool bWasAtBottom = ListView->GetScrollDistanceRemaining().Y <= KINDA_SMALL_NUMBER;
+
+	Items.Add(MakeShared<FChatHistoryEntry>(Entry));
+	TrimToMaxMessages();
+	RefreshList(bWasAtBottom);
+}
+
+void SChatMessageList::SetMessages(const TArray<FChatHistoryEntry>& Entries)
+{
+	Items.Reset(Entries.Num());
+	for (const FChatHistoryEntry& Entry : Entries)
+	{
+		Items.Add(MakeShared<FChatHistoryEntry>(Entry));
+	}
+	TrimToMaxMessages();
+	RefreshList(true);
+}
+
+void SChatMessageList::ClearMessages()
+{
+	Items.Reset();
+	ListView->RequestListRefresh();
+}
+
+void SChatMessageList::SetMaxMessages(const int32 InMaxMessages)
+{
+	MaxMessages = FMath::Max(1, InMaxMessages);
+	TrimToMaxMessages();
+	ListView->RequestListRefresh();
+}
+
+void SChatMessageList::SetTextStyle(const FTextBlockStyle* InTextStyle, const ISlateStyle* InDecoratorStyleSet)
+{
+	TextStyle = InTextStyle;
+	DecoratorStyleSet = InDecoratorStyleSet;
+
+	// Visible rows have to be generated again to pick up the new style
+	ListView->RebuildList();
+}
+
+TSharedRef<ITableRow> SChatMessageList::OnGenerateRow(const FChatItem Item,
+                                                      const TSharedRef<STableViewBase>& OwnerTable) const
+{
+	// Only called for rows that are about to become visible
+	const FString Prefix = Item->SenderName.IsEmpty() ? FString() : Item->SenderName + TEXT(": ");
+	const FText Text = FText::FromString(Prefix + Item->Message);
+
+	// Reuse the markup parsed by the chat component when the message was received
+	TSharedPtr<IRichTextMarkupParser> Parser;
+	if (Item->ParsedMessage.IsValid())
+	{
+		Parser = MakeShared<FChatCachedMarkupParser>(Item->ParsedMessage.ToSharedRef(), Prefix);
+	}
+
+	return SNew(STableRow<FChatItem>, OwnerTable)
+		.ShowSelection(false)
+		[
+			SNew(SRichTextBlock)
+			.Text(Text)
+			.Parser(Parser)
+			.TextStyle(TextStyle ? TextStyle : &FCoreStyle::Get().GetWidgetStyle<FTextBlockStyle>("NormalText"))
+			.DecoratorStyleSet(DecoratorStyleSet ? DecoratorStyleSet : &FCoreStyle::Get())
+			.AutoWrapText(true)
+		];
+}
+
+void SChatMessageList::TrimToMaxMessages()
+{
+	// The list view reads Items directly, so the cap has to be exact. Only the shared pointers are shifted
+	if (Items.Num() > MaxMessages)
+	{
+		Items.RemoveAt(0, Items.Num() - MaxMessages, false);
+	}
+}
+
+void SChatMessageList::RefreshList(const bool bWasAtBottom)
+{
+	ListView->RequestListRefresh();
+	if (bAutoScroll && bWasAtBottom)
+	{
+		ListView->ScrollToBottom();
+	}
+}
@@ -1,6 +1,7 @@
 // Copyright 2024 Iraj Mohtasham aurelion.net 
 
 #include "Slate/STitanWidgetScreenLayer.h"
+#include "ChatSystemStats.h"
 
 #include "Widgets/Layout/SBox.h"
 #include "Blueprint/WidgetLayoutLibrary.h"
@@ -161,6 +162,9 @@ void STitanWorldWidgetScreenLayer::Tick(const FGeometry& AllottedGeometry, const
                                         const float InDeltaTime)
 {
 	QUICK_SCOPE_CYCLE_COUNTER(STitanWorldWidgetScreenLayer_Tick);
+	CSV_SCOPED_TIMING_STAT(ChatSystem, ScreenLayerTick);
+	INC_DWORD_STAT_BY(STAT_ChatSystem_ProjectedWidgets, ComponentMap.Num());
+	CSV_CUSTOM_STAT(ChatSystem, ProjectedWidgets, ComponentMap.Num(), ECsvCustomStatOp::Accumulate);
 
 	if (APlayerController* PlayerController = PlayerContext.GetPlayerController())
 	{
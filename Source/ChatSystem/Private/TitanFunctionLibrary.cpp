@@ -5,6 +5,7 @@
 
 #include "AudioDevice.h"
 #include "Blueprint/UserWidget.h"
+#include "ChatSystemLog.h"
 #include "GameFramework/InputSettings.h"
 
 #include "Slate/SlateBrushAsset.h"
@@ -150,7 +151,7 @@ FSlateBrush* UTitanFunctionLibrary::StaticLoadBrush(const FString& InPath)
 	{
 		return &Cast<USlateBrushAsset>(Object)->Brush;
 	}
-	UE_LOG(LogTemp,Error,TEXT("Static load brush failed %s"),*InPath);
+	UE_LOG(LogChatUI,Error,TEXT("Static load brush failed %s"),*InPath);
 	return FCoreStyle::Get().GetDefaultBrush();
 }
 
@@ -0,0 +1,65 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "ChatSystem/ChatHistory.h"
+#include "Styling/SlateTypes.h"
+#include "ChatMessageList.generated.h"
+
+class SChatMessageList;
+class FSlateStyleSet;
+class UChatComponent;
+class UDataTable;
+
+/**
+ * Chat message list that only creates widgets for the rows visible on screen
+ * Bind it to a chat component and it follows the component's received messages
+ */
+UCLASS()
+class CHATSYSTEM_API UChatMessageList : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+	//Oldest messages are dropped once this many are shown
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="ChatMessageList")
+	int32 MaxMessages = 1000;
+	//Keep the newest message in view while the list is scrolled to the bottom
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="ChatMessageList")
+	bool AutoScroll = true;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="ChatMessageList")
+	FTextBlockStyle DefaultTextStyle;
+	//Rich text styles (RichTextStyleRow) used by tags such as <Error>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="ChatMessageList")
+	UDataTable* TextStyleSet;
+
+	//Show the history of a chat component and follow its new messages
+	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
+	void SetChatComponent(UChatComponent* InChatComponent);
+	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
+	void AddMessage(const FChatHistoryEntry& Entry);
+	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
+	void ClearMessages();
+
+	virtual void SynchronizeProperties() override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+#if WITH_EDITOR
+	virtual const FText GetPaletteCategory() override;
+#endif
+
+protected:
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+
+private:
+	void HandleHistoryEntryAdded(const FChatHistoryEntry& Entry);
+	void RebuildStyleSet();
+
+	UPROPERTY(Transient)
+	UChatComponent* ChatComponent;
+	FDelegateHandle HistoryEntryAddedHandle;
+
+	TSharedPtr<SChatMessageList> MyMessageList;
+	TSharedPtr<FSlateStyleSet> StyleInstance;
+};
@@ -0,0 +1,91 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Engine/NetSerialization.h"
+#include "ChatSystem/ChatTypes.h"
+#include "ChatAnnouncementLog.generated.h"
+
+class AChatAnnouncementLog;
+class UChatComponent;
+struct FChatAnnouncementArray;
+
+//A server announcement in the replicated announcement log
+USTRUCT()
+struct FChatAnnouncementItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	//Increases by one per announcement so clients can skip announcements they already delivered
+	UPROPERTY()
+	int32 Sequence = INDEX_NONE;
+	UPROPERTY()
+	FChatMessage Message;
+
+	void PostReplicatedAdd(const FChatAnnouncementArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FChatAnnouncementArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FChatAnnouncementItem> Items;
+
+	UPROPERTY(NotReplicated, Transient)
+	AChatAnnouncementLog* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FChatAnnouncementItem, FChatAnnouncementArray>(
+			Items, DeltaParms, *this);
+	}
+};
+
+template <>
+struct TStructOpsTypeTraits<FChatAnnouncementArray> : public TStructOpsTypeTraitsBase2<FChatAnnouncementArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Append only log of server announcements replicated to every connection.
+ * The server appends an announcement once and replication delta sends it to all clients, so the cost of an
+ * announcement doesn't grow with the player count. Late joiners receive the newest announcements with the actor
+ */
+UCLASS(NotPlaceable)
+class CHATSYSTEM_API AChatAnnouncementLog : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AChatAnnouncementLog();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Adds an announcement for every player. Server only
+	void Append(const FString& Message, const FString& SenderName);
+
+	//Delivers an announcement to the chat components of the local players
+	void DeliverToLocalPlayers(const FChatAnnouncementItem& Item) const;
+	//Delivers the announcements a component hasn't received yet, used when a local player joins after the log
+	void DeliverPending(UChatComponent* Component) const;
+
+	//Number of announcements kept for late joiners
+	UPROPERTY(EditDefaultsOnly, Category="ChatAnnouncementLog")
+	int32 MaxAnnouncements = 32;
+
+private:
+	UPROPERTY(Replicated)
+	FChatAnnouncementArray Announcements;
+
+	int32 NextSequence = 0;
+};
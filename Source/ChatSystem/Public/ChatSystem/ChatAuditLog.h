@@ -0,0 +1,57 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+
+class FRunnableThread;
+class IFileHandle;
+
+/**
+ * Chat audit log written to Saved/Logs/ChatAudit-<time>.log on a background thread.
+ * Enabled with ChatSystem.AuditLog 1. The game thread only queues the raw fields, formatting and file writes happen on
+ * the writer thread in batches
+ */
+class CHATSYSTEM_API FChatAuditLog : public FRunnable
+{
+public:
+	static FChatAuditLog& Get();
+	static bool IsEnabled();
+
+	//Queues a delivered message. Does nothing unless the audit log is enabled
+	static void Record(const FString& SenderName, uint8 TeamIndex, FName Channel, const FString& Message);
+
+	//Writes the queued entries and stops the writer thread
+	void Shutdown();
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	virtual ~FChatAuditLog() override;
+
+private:
+	struct FEntry
+	{
+		FDateTime Time;
+		FString SenderName;
+		uint8 TeamIndex;
+		FName Channel;
+		FString Message;
+	};
+
+	FChatAuditLog() = default;
+
+	void Enqueue(FEntry&& Entry);
+	void StartThread();
+	//Formats and writes everything queued so far. Writer thread only
+	void WriteQueued(FString& Buffer);
+
+	TQueue<FEntry, EQueueMode::Mpsc> Queue;
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	IFileHandle* File = nullptr;
+	FCriticalSection StartLock;
+	TAtomic<bool> bStopping{false};
+};
@@ -0,0 +1,45 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Totals of all chat strings written to the network since startup
+struct FChatCompressionStats
+{
+	//Strings written
+	int64 Strings = 0;
+	//Strings that were sent zlib compressed
+	int64 CompressedStrings = 0;
+	//Bytes the strings would have taken with the default FString serialization
+	int64 RawBytes = 0;
+	//Bytes actually written for the string payloads
+	int64 EncodedBytes = 0;
+
+	int64 GetBytesSaved() const { return RawBytes - EncodedBytes; }
+};
+
+/**
+ * Compact wire encoding for chat text.
+ * Short ANSI strings use the default FString serialization. Anything else is sent as UTF-8 and strings of at least
+ * ChatSystem.CompressionThreshold bytes are zlib compressed when that makes them smaller
+ */
+struct CHATSYSTEM_API FChatCompression
+{
+	/*Writes or reads a string. Returns false if a received payload was malformed or too large
+	 * Strings over GetMaxStringBytes are cut when written, the receiving side would fail the whole bunch otherwise*/
+	static bool SerializeString(FArchive& Ar, FString& String);
+
+	//Largest string in UTF-8 bytes the receiving side accepts, ChatSystem.MaxStringBytes
+	static int32 GetMaxStringBytes();
+	static bool ExceedsMaxBytes(const FString& String);
+	//Cuts the string so its UTF-8 encoding fits in GetMaxStringBytes. Returns true if the string was shortened
+	static bool ClampToMaxBytes(FString& String);
+
+	static FChatCompressionStats GetStats();
+	static void ResetStats();
+
+private:
+	//Number of leading characters whose UTF-8 encoding fits in GetMaxStringBytes, never splits a surrogate pair
+	static int32 GetFittingLength(const FString& String);
+};
@@ -0,0 +1,58 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EChatFilterResult : uint8
+{
+	Accept,
+	//The message was changed, for example words were masked
+	Modified,
+	//The message must not be delivered
+	Reject,
+};
+
+/**
+ * Stage of the server side chat filter pipeline.
+ * Filters run on a worker thread so they must be immutable after they are added to the chat manager
+ */
+class CHATSYSTEM_API IChatMessageFilter
+{
+public:
+	virtual ~IChatMessageFilter() = default;
+
+	virtual EChatFilterResult Filter(FString& Message) const = 0;
+};
+
+/**
+ * Case insensitive word filter backed by an Aho-Corasick automaton.
+ * The automaton is built once from the word list and finds every listed word in a single pass over the message
+ */
+class CHATSYSTEM_API FChatWordFilter : public IChatMessageFilter
+{
+public:
+	//With bInRejectMessages matching messages are dropped, otherwise the matched words are masked with MaskCharacter
+	explicit FChatWordFilter(const TArray<FString>& Words, bool bInRejectMessages = false,
+	                         TCHAR InMaskCharacter = TEXT('*'));
+
+	virtual EChatFilterResult Filter(FString& Message) const override;
+
+	int32 GetNumStates() const { return Nodes.Num(); }
+
+private:
+	struct FNode
+	{
+		TMap<TCHAR, int32> Next;
+		//State to continue from when no transition matches
+		int32 Fail = 0;
+		//Length of the longest word ending at this state, through fail links included. 0 if none
+		int32 MatchLength = 0;
+	};
+
+	int32 Step(int32 State, TCHAR Character) const;
+
+	TArray<FNode> Nodes;
+	bool bRejectMessages;
+	TCHAR MaskCharacter;
+};
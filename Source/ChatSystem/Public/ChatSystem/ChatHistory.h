@@ -0,0 +1,76 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChatHistory.generated.h"
+
+struct FChatParsedMessage;
+
+//A received chat message stored in the chat history
+USTRUCT(BlueprintType)
+struct FChatHistoryEntry
+{
+	GENERATED_BODY()
+
+	//Increases by one for every received message, can be used to page the history
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	int32 Sequence = INDEX_NONE;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FString SenderName;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	uint8 TeamIndex = 0;
+	//Channel the message was received on. None for team and all chat
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FName Channel;
+	//World time the message was received at
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	float Timestamp = 0.f;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FString Message;
+	//Message with its rich text markup parsed once on receive. Null for entries added without parsing
+	TSharedPtr<const FChatParsedMessage> ParsedMessage;
+};
+
+/**
+ * Fixed capacity ring buffer of received chat messages.
+ * Slots are allocated once and their strings are reused when the buffer wraps so long sessions don't grow memory
+ */
+class CHATSYSTEM_API FChatHistory
+{
+public:
+	explicit FChatHistory(int32 InCapacity = 200);
+
+	//Changes the capacity. Keeps the newest messages that still fit
+	void SetCapacity(int32 InCapacity);
+	int32 GetCapacity() const { return Capacity; }
+	int32 Num() const { return Count; }
+	void Reset();
+
+	//Stores a message, overwriting the oldest one once the buffer is full
+	const FChatHistoryEntry& Add(const FString& SenderName, uint8 TeamIndex, float Timestamp, const FString& Message,
+	                             const TSharedPtr<const FChatParsedMessage>& ParsedMessage = nullptr,
+	                             FName Channel = NAME_None);
+
+	//Entry with this sequence number or nullptr if it was overwritten or never received
+	const FChatHistoryEntry* Find(int32 Sequence) const;
+	//Sequence number the next received message will get
+	int32 GetNextSequence() const { return NextSequence; }
+	//Sequence number of the oldest message still in the buffer
+	int32 GetFirstSequence() const { return NextSequence - Count; }
+
+	//Newest Count messages, oldest first
+	void GetLast(int32 InCount, TArray<FChatHistoryEntry>& OutEntries) const;
+	//All messages with a sequence number of at least Sequence, oldest first
+	void GetSince(int32 Sequence, TArray<FChatHistoryEntry>& OutEntries) const;
+	//Newest MaxCount messages of a team, oldest first
+	void GetByTeam(uint8 TeamIndex, int32 MaxCount, TArray<FChatHistoryEntry>& OutEntries) const;
+
+private:
+	const FChatHistoryEntry& GetBySequence(int32 Sequence) const;
+
+	TArray<FChatHistoryEntry> Entries;
+	int32 Capacity;
+	int32 Count = 0;
+	int32 NextSequence = 0;
+};
@@ -0,0 +1,184 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ChatSystem/ChatFilter.h"
+#include "ChatSystem/ChatSpatialHash.h"
+#include "ChatSystem/ChatTypes.h"
+#include "ChatManager.generated.h"
+
+class AChatAnnouncementLog;
+class AChatReplayRecorder;
+class UChatComponent;
+
+//List of chat components that should receive a message
+USTRUCT()
+struct FChatRecipientList
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UChatComponent*> Members;
+};
+
+/**
+ * Server side registry of chat components.
+ * Components register in BeginPlay and are bucketed by team so message fan-out only touches actual recipients
+ * On clients it keeps the sender name table used to resolve sender ids of received messages
+ * Words to filter are read from the game config, [/Script/ChatSystem.ChatManager] +FilteredWords=...
+ */
+UCLASS(config=Game)
+class CHATSYSTEM_API UChatManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	static UChatManager* GetInstance(const UWorld* World);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	void RegisterComponent(UChatComponent* Component);
+	void UnregisterComponent(UChatComponent* Component);
+	//Moves a registered component from its old team bucket to its current one
+	void UpdateTeam(UChatComponent* Component, uint8 OldTeamIndex);
+	//Moves a registered component from its old name entry to its current one
+	void UpdatePlayerName(UChatComponent* Component, const FString& OldPlayerName);
+
+	/*Changes whenever a team, ping mute or player name changes or a player joins or leaves
+	 * Pings cache their per player relevancy until it changes*/
+	uint32 GetPingRelevancyEpoch() const { return PingRelevancyEpoch; }
+	void InvalidatePingRelevancy() { ++PingRelevancyEpoch; }
+
+	const TArray<UChatComponent*>& GetAllComponents() const;
+	const TArray<UChatComponent*>& GetTeamMembers(uint8 TeamIndex) const;
+	//All components using this player name (names are not guaranteed to be unique)
+	const TArray<UChatComponent*>& GetComponentsByPlayerName(const FString& PlayerName) const;
+
+	//Find the chat component of a player by name. Only valid on server
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	UChatComponent* FindComponentByPlayerName(const FString& PlayerName) const;
+
+	//Channels are server side subscriber lists, sending to a channel only touches its subscribers
+	void SubscribeToChannel(UChatComponent* Component, FName Channel);
+	void UnsubscribeFromChannel(UChatComponent* Component, FName Channel);
+	const TArray<UChatComponent*>& GetChannelSubscribers(FName Channel) const;
+	//Channels exist while they have subscribers
+	bool IsChannelRegistered(const FName Channel) const { return Channels.Contains(Channel); }
+
+	/*Components whose pawn is within Radius of the sender's pawn
+	 * Backed by a grid that is only maintained once proximity chat has been used */
+	void GetNearbyComponents(UChatComponent* Sender, float Radius, TArray<UChatComponent*>& OutComponents);
+
+	//Sum of the rate limiter counters of all registered players. Only valid on server
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	FChatRateLimitStats GetRateLimitStats() const;
+
+	/*Adds a stage to the server side filter pipeline. Filters run in the order they were added on a worker thread
+	 * Only affects messages sent after the call*/
+	void AddMessageFilter(const TSharedRef<const IChatMessageFilter, ESPMode::ThreadSafe>& Filter);
+	void RemoveMessageFilter(const TSharedRef<const IChatMessageFilter, ESPMode::ThreadSafe>& Filter);
+	/*Runs a message through the filters and calls Deliver on the game thread with the filtered text
+	 * Deliver is called right away when there are no filters, filtered messages are delivered in the order they were sent
+	 * Deliver is not called if a filter rejects the message or the sender left in the meantime*/
+	void FilterMessage(UChatComponent* Sender, const FString& Message,
+	                   TFunction<void(UChatComponent*, const FString&)>&& Deliver);
+	//Messages still being filtered or waiting for an earlier message to finish
+	int32 GetNumPendingFilteredMessages() const { return PendingFilteredMessages.Num(); }
+
+	//Schedules the outbox of a component to be flushed at the end of this frame
+	void RequestFlush(UChatComponent* Component);
+
+	//Replicated log used for server wide announcements. Spawned on first use, returns null on clients
+	AChatAnnouncementLog* GetOrSpawnAnnouncementLog();
+	AChatAnnouncementLog* GetAnnouncementLog() const { return AnnouncementLog; }
+	void SetAnnouncementLog(AChatAnnouncementLog* InAnnouncementLog);
+
+	//Records a message or ping into the replay. Does nothing unless a replay is being recorded
+	void RecordReplayMessage(const FString& SenderName, uint8 TeamIndex, FName Channel, const FString& Message);
+	void RecordReplayPing(const FString& SenderName, uint8 TeamIndex, const FVector& Location);
+	//Recorder of the replay being recorded or played back. Null otherwise
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	AChatReplayRecorder* GetReplayRecorder() const { return ReplayRecorder; }
+	void SetReplayRecorder(AChatReplayRecorder* InReplayRecorder);
+
+	void SetSenderName(int32 SenderId, const FString& Name);
+	//Name of a sender id, falls back to searching the player states if the id is not cached yet
+	FString ResolveSenderName(int32 SenderId);
+
+private:
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	//Called on the game thread when a filter task finished
+	void OnMessageFiltered(int32 Ticket, bool bAccepted, FString&& Message);
+
+	//Recorder for the replay being recorded, spawned on first use
+	AChatReplayRecorder* GetOrSpawnReplayRecorder();
+
+	//Writes the new location of components whose pawn moved or changed to the grid
+	void UpdateProximityGrid();
+	//Writes the pawn location of a component to the grid, returns false if it has no pawn
+	bool UpdateProximityLocation(UChatComponent* Component);
+	//Listens to possession and pawn movement of a component so only moved pawns are read again
+	void StartProximityTracking(UChatComponent* Component);
+	void StopProximityTracking(UChatComponent* Component);
+	void TrackProximityPawn(UChatComponent* Component, APawn* Pawn);
+
+	struct FProximityTracking
+	{
+		TWeakObjectPtr<APlayerController> Controller;
+		TWeakObjectPtr<USceneComponent> PawnRoot;
+		FDelegateHandle NewPawnHandle;
+		FDelegateHandle MovedHandle;
+	};
+
+	FChatSpatialHash ProximityGrid;
+	TMap<UChatComponent*, FProximityTracking> ProximityTracking;
+	//Components whose pawn moved or changed since the last grid update
+	TSet<UChatComponent*> DirtyProximity;
+	bool bProximityGridActive = false;
+	float TimeSinceProximityUpdate = 0.f;
+
+	//Words masked by the default word filter
+	UPROPERTY(Config)
+	TArray<FString> FilteredWords;
+	//Drop messages containing a filtered word instead of masking it
+	UPROPERTY(Config)
+	bool bRejectFilteredMessages = false;
+
+	TArray<TSharedRef<const IChatMessageFilter, ESPMode::ThreadSafe>> MessageFilters;
+
+	//Message waiting for its turn to be delivered after filtering
+	struct FPendingFilteredMessage
+	{
+		TWeakObjectPtr<UChatComponent> Sender;
+		TFunction<void(UChatComponent*, const FString&)> Deliver;
+		bool bFinished = false;
+		bool bAccepted = false;
+		FString Message;
+	};
+	//Filter tasks can finish in any order, messages are delivered by ticket so players see them in send order
+	TMap<int32, FPendingFilteredMessage> PendingFilteredMessages;
+	int32 NextFilterTicket = 0;
+	int32 NextDeliveryTicket = 0;
+
+	FDelegateHandle PostActorTickHandle;
+	uint32 PingRelevancyEpoch = 0;
+	UPROPERTY()
+	TArray<UChatComponent*> Components;
+	UPROPERTY()
+	TMap<uint8, FChatRecipientList> Teams;
+	UPROPERTY()
+	TMap<FString, FChatRecipientList> Names;
+	UPROPERTY()
+	TMap<FName, FChatRecipientList> Channels;
+	//Sender id to player name. Entries are kept after players leave so late messages still resolve
+	TMap<int32, FString> SenderNames;
+	UPROPERTY()
+	AChatAnnouncementLog* AnnouncementLog;
+	UPROPERTY()
+	AChatReplayRecorder* ReplayRecorder;
+	//Components with queued messages this frame
+	UPROPERTY()
+	TArray<UChatComponent*> PendingFlush;
+};
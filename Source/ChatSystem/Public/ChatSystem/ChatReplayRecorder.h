@@ -0,0 +1,119 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Engine/NetSerialization.h"
+#include "ChatReplayRecorder.generated.h"
+
+class AChatReplayRecorder;
+struct FChatReplayEventArray;
+
+UENUM(BlueprintType)
+enum class EChatReplayEventType : uint8
+{
+	Message,
+	Announcement,
+	Ping,
+};
+
+//A chat message or ping recorded into a replay
+USTRUCT(BlueprintType)
+struct FChatReplayEvent : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	//Replay time the event happened at, matches the time used for scrubbing
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	float Timestamp = 0.f;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	EChatReplayEventType Type = EChatReplayEventType::Message;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FString SenderName;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	uint8 TeamIndex = 0;
+	//Channel of the message. None for team and all chat
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FName Channel;
+	//Message text. Empty for pings
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FString Message;
+	//Ping location. Zero for messages
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	void PostReplicatedAdd(const FChatReplayEventArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FChatReplayEventArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FChatReplayEvent> Items;
+
+	UPROPERTY(NotReplicated, Transient)
+	AChatReplayRecorder* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FChatReplayEvent, FChatReplayEventArray>(
+			Items, DeltaParms, *this);
+	}
+};
+
+template <>
+struct TStructOpsTypeTraits<FChatReplayEventArray> : public TStructOpsTypeTraitsBase2<FChatReplayEventArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChatReplayEvent, const FChatReplayEvent&, Event);
+
+/**
+ * Records chat messages and pings into replays.
+ * Chat reaches clients through owner only RPCs which replays don't capture, so the server keeps the events in a
+ * replay only property instead. The recorder is only spawned while a replay is being recorded and only replicates through
+ * the demo net driver, live connections never open a channel for it.
+ * During playback the events arrive with the replay timeline and follow scrubbing
+ */
+UCLASS(NotPlaceable)
+class CHATSYSTEM_API AChatReplayRecorder : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AChatReplayRecorder();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Adds an event at the current replay time. Recording only
+	void Record(FChatReplayEvent& Event);
+
+	//Events of the replay up to the current playback time, oldest first
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	const TArray<FChatReplayEvent>& GetEvents() const { return Events.Items; }
+	//Events between two replay times, oldest first
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	TArray<FChatReplayEvent> GetEventsBetween(float StartTime, float EndTime) const;
+
+	//Called during playback for every event the replay reaches, including events replayed after scrubbing
+	UPROPERTY(BlueprintAssignable)
+	FOnChatReplayEvent OnReplayEvent;
+
+	/*Oldest events are dropped past this many to keep checkpoints small
+	 * They are dropped in batches, up to a quarter more events are kept between trims*/
+	UPROPERTY(EditDefaultsOnly, Category="ChatReplayRecorder")
+	int32 MaxEvents = 1000;
+
+private:
+	UPROPERTY(Replicated)
+	FChatReplayEventArray Events;
+};
@@ -0,0 +1,30 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Framework/Text/IRichTextMarkupParser.h"
+
+//Chat message with its rich text markup parsed once when received
+struct CHATSYSTEM_API FChatParsedMessage
+{
+	//Display string with the markup removed, the parse results index into it
+	FString Text;
+	TArray<FTextLineParseResults> Lines;
+
+	static TSharedRef<const FChatParsedMessage> Parse(const FString& Input);
+};
+
+/*Rich text parser that hands out the cached result of a parsed message instead of parsing again
+ * An optional plain prefix (such as the sender name) is put in front of the first line */
+class CHATSYSTEM_API FChatCachedMarkupParser : public IRichTextMarkupParser
+{
+public:
+	FChatCachedMarkupParser(const TSharedRef<const FChatParsedMessage>& InParsedMessage, const FString& InPrefix);
+
+	virtual void Process(TArray<FTextLineParseResults>& Results, const FString& Input, FString& Output) override;
+
+private:
+	TSharedRef<const FChatParsedMessage> ParsedMessage;
+	FString Prefix;
+};
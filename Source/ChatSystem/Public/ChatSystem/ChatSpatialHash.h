@@ -0,0 +1,44 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UChatComponent;
+
+/**
+ * Uniform 2D grid of chat components bucketed by the position of their pawn.
+ * Components only move between cells when they cross a cell border, queries only visit the cells overlapping the radius
+ */
+class CHATSYSTEM_API FChatSpatialHash
+{
+public:
+	explicit FChatSpatialHash(float InCellSize = 2500.f);
+
+	//Changing the cell size rebuckets every tracked component
+	void SetCellSize(float InCellSize);
+	float GetCellSize() const { return CellSize; }
+
+	//Moves a component to the cell of Location if it changed cells
+	void Update(UChatComponent* Component, const FVector& Location);
+	void Remove(UChatComponent* Component);
+	void Reset();
+	bool Contains(const UChatComponent* Component) const { return Locations.Contains(Component); }
+
+	//Components within Radius of Center using the last updated locations
+	void Query(const FVector& Center, float Radius, TArray<UChatComponent*>& OutComponents) const;
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+	void RemoveFromCell(UChatComponent* Component, const FIntPoint& Cell);
+
+	struct FTrackedLocation
+	{
+		FVector Location;
+		FIntPoint Cell;
+	};
+
+	float CellSize;
+	TMap<FIntPoint, TArray<UChatComponent*>> Cells;
+	TMap<const UChatComponent*, FTrackedLocation> Locations;
+};
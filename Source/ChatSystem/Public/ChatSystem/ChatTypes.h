@@ -0,0 +1,145 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/CoreNet.h"
+#include "ChatTypes.generated.h"
+
+//How messages are delivered from the server to a client
+UENUM(BlueprintType)
+enum class EChatDeliveryMode : uint8
+{
+	//Always sent reliably, a burst can overflow the reliable buffer of a slow connection
+	Reliable,
+	//Sent unreliably, messages can be lost but never stall or disconnect the client
+	Unreliable,
+	//Sent reliably while the connection keeps up, held on the server while too many reliable bunches are unacknowledged
+	ReliableCapped,
+};
+
+/*Compact record of a single chat message as delivered to a client
+ * Messages from players only carry the sender's PlayerId, clients resolve the name from their local name table.
+ * The sender name is only sent for senders without an id (server announcements) */
+USTRUCT()
+struct FChatMessage
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint8 TeamIndex = 0;
+	UPROPERTY()
+	FString Message;
+	//PlayerId of the sender. INDEX_NONE when the sender is not a player
+	UPROPERTY()
+	int32 SenderId = INDEX_NONE;
+	//Only sent when SenderId is INDEX_NONE
+	UPROPERTY()
+	FString SenderName;
+	//Channel the message was sent on. None for team and all chat
+	UPROPERTY()
+	FName Channel;
+
+	FChatMessage()
+	{
+	}
+
+	FChatMessage(const uint8 InTeamIndex, const FString& InMessage, const int32 InSenderId, const FString& InSenderName,
+	             const FName InChannel = NAME_None)
+		: TeamIndex(InTeamIndex), Message(InMessage), SenderId(InSenderId), SenderName(InSenderName), Channel(InChannel)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template <>
+struct TStructOpsTypeTraits<FChatMessage> : public TStructOpsTypeTraitsBase2<FChatMessage>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+//Chat text sent from a client to the server, serialized with the compact chat string encoding
+USTRUCT()
+struct FChatEncodedString
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString Text;
+
+	FChatEncodedString()
+	{
+	}
+
+	FChatEncodedString(const FString& InText)
+		: Text(InText)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template <>
+struct TStructOpsTypeTraits<FChatEncodedString> : public TStructOpsTypeTraitsBase2<FChatEncodedString>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/*Player name with its hash computed once, key of the mute and ban sets
+ * Compared case insensitively like player names. Names come from clients, so they are not turned into FNames which would
+ * stay in the global name table forever*/
+struct FChatPlayerKey
+{
+	FChatPlayerKey() = default;
+	explicit FChatPlayerKey(const FString& InName) : Name(InName), Hash(GetTypeHash(InName))
+	{
+	}
+
+	const FString& GetName() const { return Name; }
+	bool IsEmpty() const { return Name.IsEmpty(); }
+
+	bool operator==(const FChatPlayerKey& Other) const
+	{
+		return Hash == Other.Hash && Name.Equals(Other.Name, ESearchCase::IgnoreCase);
+	}
+
+	friend uint32 GetTypeHash(const FChatPlayerKey& Key) { return Key.Hash; }
+
+private:
+	FString Name;
+	uint32 Hash = 0;
+};
+
+//Token bucket used by the server to limit how often a client may send messages or pings
+struct FChatTokenBucket
+{
+	float Tokens = -1.f;
+	double LastRefillTime = 0;
+
+	/*Refills the bucket for the time passed and consumes a token if one is available
+	 * A rate of zero or less disables the limit*/
+	bool TryConsume(double Now, float TokensPerSecond, float BurstSize);
+};
+
+//Counters of the server side rate limiter
+USTRUCT(BlueprintType)
+struct FChatRateLimitStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	int32 AcceptedMessages = 0;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	int32 RejectedMessages = 0;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	int32 AcceptedPings = 0;
+	UPROPERTY(BlueprintReadOnly, Category="ChatSystem")
+	int32 RejectedPings = 0;
+};
@@ -0,0 +1,24 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*Most verbose log level compiled into the plugin. Calls above it are removed at compile time, arguments included
+ * Shipping and test builds keep warnings and errors only, define CHATSYSTEM_LOG_COMPILED_VERBOSITY to override*/
+#ifndef CHATSYSTEM_LOG_COMPILED_VERBOSITY
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+#define CHATSYSTEM_LOG_COMPILED_VERBOSITY Warning
+#else
+#define CHATSYSTEM_LOG_COMPILED_VERBOSITY All
+#endif
+#endif
+
+//Component lifetime, names, teams, bans and other rare events
+CHATSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogChatSystem, Log, CHATSYSTEM_LOG_COMPILED_VERBOSITY);
+//Per message events. Off by default, enable with log LogChatMessages Verbose
+CHATSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogChatMessages, Warning, CHATSYSTEM_LOG_COMPILED_VERBOSITY);
+//Per ping events. Off by default
+CHATSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogChatPing, Warning, CHATSYSTEM_LOG_COMPILED_VERBOSITY);
+//Widgets of the plugin. Off by default
+CHATSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogChatUI, Warning, CHATSYSTEM_LOG_COMPILED_VERBOSITY);
@@ -0,0 +1,52 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+// stat ChatSystem
+DECLARE_STATS_GROUP(TEXT("ChatSystem"), STATGROUP_ChatSystem, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SendString"), STAT_ChatSystem_SendString, STATGROUP_ChatSystem, CHATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("NotifyMessageReceived"), STAT_ChatSystem_NotifyMessageReceived, STATGROUP_ChatSystem,
+                          CHATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SpawnPingAtLocation"), STAT_ChatSystem_SpawnPingAtLocation, STATGROUP_ChatSystem,
+                          CHATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ping IsNetRelevantFor"), STAT_ChatSystem_PingIsNetRelevantFor, STATGROUP_ChatSystem,
+                          CHATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("WidgetComponent Tick"), STAT_ChatSystem_WidgetComponentTick, STATGROUP_ChatSystem,
+                          CHATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DrawWidgetToRenderTarget"), STAT_ChatSystem_DrawWidgetToRenderTarget,
+                          STATGROUP_ChatSystem, CHATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("POI Update"), STAT_ChatSystem_POIUpdate, STATGROUP_ChatSystem, CHATSYSTEM_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Messages Sent"), STAT_ChatSystem_MessagesSent, STATGROUP_ChatSystem,
+                                  CHATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Messages Received"), STAT_ChatSystem_MessagesReceived, STATGROUP_ChatSystem,
+                                  CHATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Client Message RPCs"), STAT_ChatSystem_ClientMessageRpcs, STATGROUP_ChatSystem,
+                                  CHATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Projected Widgets"), STAT_ChatSystem_ProjectedWidgets, STATGROUP_ChatSystem,
+                                  CHATSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Pings"), STAT_ChatSystem_ActivePings, STATGROUP_ChatSystem,
+                                      CHATSYSTEM_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Widget Render Targets"), STAT_ChatSystem_RenderTargetMemory, STATGROUP_ChatSystem,
+                           CHATSYSTEM_API);
+
+// -csvCategories=ChatSystem
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(CHATSYSTEM_API, ChatSystem);
+
+//Running totals written to the CSV profile once per frame. Stats are compiled out of shipping like builds, these are not
+struct CHATSYSTEM_API FChatSystemCounters
+{
+	static int32 ActivePings;
+	static int64 RenderTargetBytes;
+	//Calls into the client message RPCs and the messages they carried since startup
+	static int64 ClientMessageRpcs;
+	static int64 ClientMessagesSent;
+
+	//Samples the running totals into the current CSV frame
+	static void RecordCsvFrame();
+};
@@ -5,12 +5,20 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "GameFramework/PlayerState.h"
+#include "ChatSystem/ChatHistory.h"
+#include "ChatSystem/ChatTypes.h"
+#include "ChatSystemLog.h"
+#include "PingSystem/PingRing.h"
+#include "UObject/ObjectKey.h"
 #include "ChatComponent.generated.h"
+class AChatAnnouncementLog;
 class APingActor;
-DECLARE_LOG_CATEGORY_EXTERN(LogChatSystem, Log, All);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnReciveMessage, const FString&, PlayerName, uint8, SenderTeamIndex,
                                               uint8, MyTeamIndex, const FString&, Message);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnReceiveChannelMessage, const FString&, PlayerName, FName, Channel,
+                                              uint8, SenderTeamIndex, const FString&, Message);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnChatHistoryEntryAdded, const FChatHistoryEntry&);
 
 /*Class to handle a replicated chat system
  * Needs to be attached to a player controller for correct replication
@@ -28,9 +36,7 @@ public:
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
-
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
-	                           FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 public:
 	// Key to open chat. you can also handle this manually
 	UPROPERTY(EditAnywhere, Category="ChatComponent")
@@ -62,9 +68,33 @@ public:
 
 	//
 	UFUNCTION(Server, Reliable)
-	void SendStringOnServer(const FString& Input);
+	void SendStringOnServer(const FChatEncodedString& Input);
+	UFUNCTION(Server, Reliable)
+	void SendToAllStringToServer(const FChatEncodedString& Input);
+
+	//Send message to every subscriber of a channel. Sender must be subscribed to the channel
+	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
+	void SendStringToChannel(const FString& Input, FName Channel);
+	//The channel is sent as a string, the server only resolves names of channels it already has
 	UFUNCTION(Server, Reliable)
-	void SendToAllStringToServer(const FString& Input);
+	void SendStringToChannelOnServer(const FChatEncodedString& Input, const FString& Channel);
+
+	//Send message to players whose pawn is within ProximityChatRadius. Received on the Local channel
+	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
+	void SendLocalString(const FString& Input);
+	UFUNCTION(Server, Reliable)
+	void SendLocalStringOnServer(const FChatEncodedString& Input);
+	//Channel name proximity messages are received on
+	static const FName LocalChannel;
+
+	//Channels such as squads or parties. Subscriptions are managed by the server
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
+	void SubscribeToChannel(FName Channel);
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
+	void UnsubscribeFromChannel(FName Channel);
+	UFUNCTION(BlueprintCallable, BlueprintPure, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
+	bool IsSubscribedToChannel(FName Channel) const;
+	const TSet<FName>& GetSubscribedChannels() const { return SubscribedChannels; }
 
 
 	UFUNCTION(Server, Reliable)
@@ -74,11 +104,31 @@ public:
 	void SetPlayerName(const FString& Input);
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
 	const FString& GetPlayerName() const;
-
-	void NotifyMessageReceived(uint8 TeamIndex, const FString& Input, const FString& SenderName);
+	//Hashed identity of the player name used by mute and ban sets
+	const FChatPlayerKey& GetPlayerNameKey() const { return PlayerNameKey; }
+	//Compact per session id of this player sent in place of the player name
+	int32 GetSenderId() const;
+
+	//SenderId is the PlayerId of the sender or INDEX_NONE for server messages
+	void NotifyMessageReceived(uint8 TeamIndex, const FString& Input, const FString& SenderName,
+	                           int32 SenderId = INDEX_NONE, FName Channel = NAME_None);
+	//Messages generated in a frame are coalesced and delivered to the owning client in one RPC
 	UFUNCTION(Client, Reliable)
-	void NotifyMessageReceivedOnClient(uint8 TeamIndex, const FString& Input, const FString& SenderName);
-
+	void NotifyMessagesReceivedOnClient(const TArray<FChatMessage>& Messages);
+	UFUNCTION(Client, Unreliable)
+	void NotifyMessagesReceivedOnClientUnreliable(const TArray<FChatMessage>& Messages);
+	/*Sends queued messages to the owning client. Called by the chat manager at the end of the frame
+	 * Capped messages stay queued while the connection is backed up and are drained over the following frames*/
+	void FlushOutbox();
+	//Number of capped messages waiting on the server for the connection to catch up
+	int32 GetNumHeldMessages() const { return CappedOutbox.Num(); }
+
+
+	//Called by the announcement log for the chat components of local players
+	void ReceiveAnnouncement(const AChatAnnouncementLog* Log, int32 Sequence, const FChatMessage& Message);
+	/*Called by the announcement log on the server for the chat components of remote players
+	 * Their client receives the announcement from the log, this only fires OnReceiveMessage for server side listeners*/
+	void NotifyAnnouncementOnServer(const FChatMessage& Message);
 
 	//Make A server Announcement Can be called from any chat component
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
@@ -95,10 +145,12 @@ public:
 	void MutePlayer(const FString& Player);
 	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
 	void UnMutePlayer(const FString& Player);
+	//Change the list through MutePlayer and UnMutePlayer, edits to the returned array are not applied
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
 	TArray<FString>& GetMutedPlayers();
 
 
+	//Ignore all chat and local chat from other teams. Named channels are team agnostic and are not affected
 	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
 	void SetMuteEnemies(bool Mute);
 
@@ -106,27 +158,123 @@ public:
 	void BanPlayerFromChatAndPing(const FString& Player);
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
 	void UnBanPlayerFromChatAndPing(const FString& Player);
+	//Change the list through BanPlayerFromChatAndPing and UnBanPlayerFromChatAndPing, edits to the returned array are not applied
 	UFUNCTION(BlueprintCallable, BlueprintPure, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
 	TArray<FString>& GetBannedPlayers();
 
 	UPROPERTY(BlueprintAssignable)
 	FOnReciveMessage OnReceiveMessage;
+	//Called for messages received on a channel instead of OnReceiveMessage
+	UPROPERTY(BlueprintAssignable)
+	FOnReceiveChannelMessage OnReceiveChannelMessage;
+
+	//Newest Count received messages, oldest first
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	TArray<FChatHistoryEntry> GetLastMessages(int32 Count) const;
+	//Received messages with a sequence number of at least Sequence, oldest first
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	TArray<FChatHistoryEntry> GetMessagesSince(int32 Sequence) const;
+	//Newest MaxCount received messages of a team, oldest first
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	TArray<FChatHistoryEntry> GetTeamMessages(uint8 TeamIndex, int32 MaxCount) const;
+	const FChatHistory& GetHistory() const { return History; }
+	//Native notification for every message added to the history, used by list widgets
+	FOnChatHistoryEntryAdded OnHistoryEntryAdded;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	static UChatComponent* GetChatComponent(APlayerController* PlayerController);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
+	static UChatComponent* GetChatComponentFromPlayerState(APlayerState* PlayerState);
+
+	//Rate limiter counters of this player. Only valid on server
+	UFUNCTION(BlueprintCallable, BlueprintPure, BlueprintAuthorityOnly, Category="TitanUMG|ChatSystem")
+	const FChatRateLimitStats& GetRateLimitStats() const;
 
 
 private:
 	UPROPERTY(Replicated)
 	uint8 MyTeamIndex;
 
+	//Server side registry used for message fan-out. Only valid on authority
 	UPROPERTY(Transient)
-	TArray<FString> MutedPlayers;
+	class UChatManager* ChatManager;
+
+	//Sequence of the newest announcement log entry delivered to this component
+	int32 LastAnnouncementSequence = INDEX_NONE;
+	//Log LastAnnouncementSequence belongs to, a respawned log starts its sequence over
+	TWeakObjectPtr<const AChatAnnouncementLog> LastAnnouncementLog;
+
+	//Messages waiting to be sent to the owning client, one queue per delivery mode
+	TArray<FChatMessage> Outbox;
+	TArray<FChatMessage> UnreliableOutbox;
+	TArray<FChatMessage> CappedOutbox;
+
+	//Delivery of player messages to this player
+	UPROPERTY(EditAnywhere, Category="ChatComponent|Delivery")
+	EChatDeliveryMode ChatDeliveryMode = EChatDeliveryMode::Reliable;
+	//Delivery of server announcements to this player
+	UPROPERTY(EditAnywhere, Category="ChatComponent|Delivery")
+	EChatDeliveryMode AnnouncementDeliveryMode = EChatDeliveryMode::Reliable;
+	//Capped messages are held while the connection has this many unacknowledged reliable bunches
+	UPROPERTY(EditAnywhere, Category="ChatComponent|Delivery")
+	int32 MaxPendingReliableBunches = 64;
+	//Capped messages sent per frame while draining
+	UPROPERTY(EditAnywhere, Category="ChatComponent|Delivery")
+	int32 MaxCappedMessagesPerFlush = 32;
+	//Drop the oldest held messages once more than MaxHeldMessages are held. Otherwise they are held until the connection catches up
+	UPROPERTY(EditAnywhere, Category="ChatComponent|Delivery")
+	bool bDropHeldMessagesOnOverflow = false;
+	//Held messages kept when bDropHeldMessagesOnOverflow is set
+	UPROPERTY(EditAnywhere, Category="ChatComponent|Delivery", meta=(EditCondition="bDropHeldMessagesOnOverflow"))
+	int32 MaxHeldMessages = 256;
+
+	void QueueMessage(const FChatMessage& Message, EChatDeliveryMode DeliveryMode);
+	//True while the reliable buffer of the owning connection is too full for more capped messages
+	bool IsReliableBufferSaturated() const;
+	//Every client message RPC goes through here so they can be counted
+	void SendMessagesToClient(const TArray<FChatMessage>& Messages, bool bReliable);
+	void ReceiveMessages(const TArray<FChatMessage>& Messages);
+
+	//Distance from the sender's pawn that proximity messages reach
+	UPROPERTY(EditAnywhere, Category="ChatComponent")
+	float ProximityChatRadius = 2000.f;
+
+	//Channels this player is subscribed to. Only valid on authority
 	UPROPERTY(Transient)
-	TArray<FString> PingMutedPlayers;
+	TSet<FName> SubscribedChannels;
+
+	//Checks shared by every server side send path
+	bool CanSendOnServer(const FString& Input);
+	//Fan-out of a message that passed the chat manager's filters. Channel is None for team and all chat
+	void DeliverFilteredMessage(const FString& Input, bool SendToAll, FName Channel);
+
+	//Number of received messages kept in the history
+	UPROPERTY(EditAnywhere, Category="ChatComponent")
+	int32 HistoryCapacity = 200;
+	//Received messages of the local player. Not used for remote players on the server
+	FChatHistory History;
+
+	//Mute and ban lists are keyed by player name key so hot path checks are a hash lookup
+	TSet<FChatPlayerKey> MutedPlayers;
+	TSet<FChatPlayerKey> PingMutedPlayers;
 	bool MuteEnemies;
+	TSet<FChatPlayerKey> BannedPlayers;
+	//Names in the mute and ban lists in the order they were added, returned by the getters without building a copy
+	UPROPERTY(Transient)
+	TArray<FString> MutedPlayerNames;
 	UPROPERTY(Transient)
-	TArray<FString> BannedPlayers;
+	TArray<FString> PingMutedPlayerNames;
+	UPROPERTY(Transient)
+	TArray<FString> BannedPlayerNames;
+	static void AddPlayerToList(TSet<FChatPlayerKey>& Keys, TArray<FString>& Names, const FString& Player);
+	static void RemovePlayerFromList(TSet<FChatPlayerKey>& Keys, TArray<FString>& Names, const FString& Player);
 
-	UPROPERTY(Replicated)
+	UPROPERTY(ReplicatedUsing=OnRep_PlayerName)
 	FString PlayerName = TEXT("None");
+	FChatPlayerKey PlayerNameKey;
+
+	UFUNCTION()
+	void OnRep_PlayerName();
 
 	//Message to show when banned player is attempting to send messages 
 	UPROPERTY(EditAnywhere, Category="ChatComponent")
@@ -135,10 +283,30 @@ private:
 	//Optional Server Name
 	UPROPERTY(EditAnywhere, Category="ChatComponent")
 	FString ServerMessageSenderName;
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
-	static UChatComponent* GetChatComponent(APlayerController* PlayerController);
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
-	static UChatComponent* GetChatComponentFromPlayerState(APlayerState* PlayerState);
+
+	//Server side limit of messages a client can send per second. 0 disables the limit
+	UPROPERTY(EditAnywhere, Category="ChatComponent|RateLimit")
+	float MessagesPerSecond = 1.f;
+	//Number of messages a client can send at once before the limit kicks in
+	UPROPERTY(EditAnywhere, Category="ChatComponent|RateLimit")
+	float MessageBurstSize = 5.f;
+	//Server side limit of pings a client can place per second. 0 disables the limit
+	UPROPERTY(EditAnywhere, Category="ChatComponent|RateLimit")
+	float PingsPerSecond = 2.f;
+	//Number of pings a client can place at once before the limit kicks in
+	UPROPERTY(EditAnywhere, Category="ChatComponent|RateLimit")
+	float PingBurstSize = 5.f;
+	//Message to show when a player is sending messages too fast. Sent once per rejected burst
+	UPROPERTY(EditAnywhere, Category="ChatComponent|RateLimit")
+	FString RateLimitMessage = TEXT("</> <Error> You are sending messages too fast");
+
+	FChatTokenBucket MessageBucket;
+	FChatTokenBucket PingBucket;
+	bool bNotifiedRateLimit = false;
+	FChatRateLimitStats RateLimitStats;
+
+	//Authoritative rate limit check for messages received from the owning client
+	bool ConsumeMessageToken();
 
 
 	//Ping system
@@ -156,6 +324,9 @@ private:
 	UFUNCTION(Server, Reliable)
 	void SpawnPingAtLocationServer(FVector Location, TSubclassOf<APingActor> PingClass);
 
+	//Called by a ping of this player when it ends on the server
+	void OnPingEnded(const APingActor* Ping);
+
 
 public:
 	UFUNCTION(BlueprintCallable, Category="TitanUMG|ChatSystem")
@@ -164,12 +335,16 @@ public:
 	void UnMutePlayerPings(const FString& Player);
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="TitanUMG|ChatSystem")
 	const TArray<FString>& GetPingMutedPlayers() const;
+	bool IsPlayerPingMuted(const FChatPlayerKey& PlayerKey) const;
+	bool HasPingMutedPlayers() const { return PingMutedPlayers.Num() > 0; }
 
 
 private:
+	//World time of the last accepted ping, the ping cooldown is computed from it so the component never ticks
 	UPROPERTY(Transient)
-	float PingTimer;
+	double LastPingTime = -DBL_MAX;
 
-	UPROPERTY(Transient)
-	TArray<AActor*> SpawnedPings;
+	/*Pings this player has in the world per ping class, the rings hold weak handles so pooled or destroyed pings are never kept alive
+	 * Keyed by object key so a ping class that is unloaded or reinstanced never leaves a dangling key behind*/
+	TMap<TObjectKey<UClass>, FPingRing> OwnedPings;
 };
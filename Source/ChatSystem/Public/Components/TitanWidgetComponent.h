@@ -363,6 +363,8 @@ protected:
 	void RegisterWindow();
 	void UnregisterWindow();
 	void RemoveWidgetFromScreen();
+	/** Screen space widgets are removed right away instead of on the next tick, which may not run for pooled owners. */
+	virtual void OnHiddenInGameChanged() override;
 
 	/** Allows subclasses to control if the widget should be drawn.  Called right before we draw the widget. */
 	virtual bool ShouldDrawWidget() const;
@@ -587,6 +589,10 @@ private:
 	static EVisibility ConvertWindowVisibilityToVisibility(EWindowVisibility visibility);
 
 	void OnWidgetVisibilityChanged(ESlateVisibility InVisibility);
+	/** Updates the render target memory stat with the current size of the render target */
+	void SetTrackedRenderTargetMemory(int64 Bytes);
+	/** Render target memory currently reported for this component */
+	int64 TrackedRenderTargetMemory = 0;
 	/** Set to true after a draw of an empty component.*/
 	bool bRenderCleared;
 	bool bOnWidgetVisibilityChangedRegistered;
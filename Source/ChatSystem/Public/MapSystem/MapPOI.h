@@ -22,6 +22,11 @@ protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override; // Add this EndPlay function
 public:	
+	// Adds the POI back to the maps, used when a pooled owner is reused
+	virtual void Activate(bool bReset = false) override;
+	// Takes the POI off the maps without destroying it
+	virtual void Deactivate() override;
+
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
@@ -46,6 +51,8 @@ public:
 	UUserWidget* GetWidgetFor(UUserWidget* MapWidget);
 	UPROPERTY()
 	class UPOIManager* POIManager;
+private:
+	bool bAddedToManager=false;
 public:
 	
 	//List of widgets owned by this POI (one for each map instance) Key is map widget and value is POI widget
@@ -6,10 +6,22 @@
 #include "Components/SphereComponent.h"
 #include "Components/WidgetComponent.h"
 #include "GameFramework/Actor.h"
-#include "TimerManager.h"
 #include "PingActor.generated.h"
 
 class UTitanWidgetComponent;
+
+//Replicated activation of a pooled ping. Activation changes every time the ping is reused
+USTRUCT()
+struct FPingActivationState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	bool bActive = true;
+	UPROPERTY()
+	uint8 Activation = 0;
+};
+
 UCLASS(Abstract,Blueprintable)
 class CHATSYSTEM_API APingActor : public AActor
 {
@@ -22,12 +34,10 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="Components")
 	USphereComponent* SphereComponent;
 	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="Components")
@@ -51,6 +61,9 @@ public:
 	bool IsPingReadyToDestroy();
 	UFUNCTION(BlueprintImplementableEvent)
 	void PingBeginDestroy();
+	//Called when a pooled ping is reused, reset anything PingBeginDestroy changed
+	UFUNCTION(BlueprintImplementableEvent)
+	void PingActivated();
 	//only valid on owning client and server 
 	UFUNCTION(BlueprintCallable,BlueprintPure,Category="TitanUMG|PingActor")
 	class UChatComponent* GetOwningChatComponent()const;
@@ -65,10 +78,57 @@ public:
 	UPROPERTY(Replicated,BlueprintReadOnly,Category="Behavior")
 	uint8 TeamIndex;
 
-	
-	FTimerHandle TimerHandle;
 
 	bool PingPendingDestroy;
 	virtual void TornOff() override;
+
+	//Finished pings are hidden and reused by the ping manager instead of being destroyed
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Pooling")
+	bool bPoolable=true;
+	//Number of finished pings of this class kept for reuse
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Pooling")
+	int32 MaxPooledPings=8;
+
+	UFUNCTION(BlueprintCallable,BlueprintPure,Category="TitanUMG|PingActor")
+	bool IsPingActive() const { return ActivationState.bActive; }
+	//Reuses a pooled ping at a new location for a new owner. Server only, called by the ping manager
+	void ActivatePing(const FVector& Location, AActor* NewOwner, const FString& InOwningPlayerName, uint8 InTeamIndex);
+	//Hides the ping and puts it to sleep until it is reused. Server only, called by the ping manager
+	void DeactivatePing();
+
+private:
+	friend class UPingManager;
+
+	UPROPERTY(ReplicatedUsing=OnRep_ActivationState)
+	FPingActivationState ActivationState;
+
+	UFUNCTION()
+	void OnRep_ActivationState(const FPingActivationState& PreviousState);
+
+	//Schedules the end of the ping on the ping manager, which owns the expirations of all pings
+	void StartLifeTime();
+	void StopLifeTime();
+	void OnLifeTimeExpired();
+	//World time the ping expires at, the ping manager ignores queued expirations that don't match it
+	double ExpireTime=-1.0;
+	//Starts the end of the ping, it is released or destroyed once IsPingReadyToDestroy returns true
+	void BeginPingEnd();
+	//Marks the ping pending destroy, the ping manager polls IsPingReadyToDestroy until it returns true
+	void SetPendingDestroy();
+	//Releases or destroys the ping once IsPingReadyToDestroy returned true
+	void FinishPingEnd();
+	void SetPingVisible(bool bVisible);
+	void SetCountedActive(bool bActive);
+	//Lets the owning player's chat component forget this ping
+	void NotifyOwnerPingEnded();
+	bool bCountedActive=false;
+
+	//Team and mute check of IsNetRelevantFor, without the cache
+	bool IsVisibleToPlayer(const APlayerController* Viewer) const;
+	UPROPERTY(Transient)
+	class UChatManager* ChatManager;
+	//Team and mute result per viewing player, cleared when the ping is reused or the chat manager's relevancy epoch changes
+	mutable TMap<const APlayerController*, bool> RelevancyCache;
+	mutable uint32 RelevancyCacheEpoch=0;
 	
 };
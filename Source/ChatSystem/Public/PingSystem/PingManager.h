@@ -0,0 +1,75 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "PingManager.generated.h"
+
+class APingActor;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPingReactivated, APingActor*);
+
+//Inactive ping actors of one class waiting to be reused
+USTRUCT()
+struct FPingActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<APingActor*> Inactive;
+};
+
+//Queued end of a ping's lifetime
+struct FPingExpiration
+{
+	TWeakObjectPtr<APingActor> Ping;
+	double ExpireTime;
+
+	bool operator<(const FPingExpiration& Other) const { return ExpireTime < Other.ExpireTime; }
+};
+
+/**
+ * Server side pool of ping actors and owner of every ping's lifetime.
+ * Finished pings are hidden and put to sleep with net dormancy instead of being destroyed, the next ping of the same
+ * class reuses them so spam pinging doesn't pay for actor spawning, component registration and actor channels.
+ * Pings don't tick or own timers, expirations are kept in a single min-heap and only pings pending destroy are polled
+ */
+UCLASS()
+class CHATSYSTEM_API UPingManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	static UPingManager* GetInstance(const UWorld* World);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//Reuses a pooled ping of this class or spawns a new one, then activates it at Location. Server only
+	APingActor* AcquirePing(TSubclassOf<APingActor> PingClass, const FVector& Location, AActor* Owner,
+	                        const FString& OwningPlayerName, uint8 TeamIndex);
+	//Returns a finished ping to its pool, pings that opted out of pooling or don't fit in the pool are destroyed
+	void ReleasePing(APingActor* Ping);
+
+	int32 GetNumPooled(TSubclassOf<APingActor> PingClass) const;
+	//Called when a pooled ping is reused, it can change owner and team without being added to the world again
+	FOnPingReactivated OnPingReactivated;
+
+	//Ends the ping after LifeTime seconds, replaces any expiration the ping already had. Server only
+	void ScheduleExpiration(APingActor* Ping, float LifeTime);
+	//Polls IsPingReadyToDestroy on the ping every frame until it returns true
+	void AddPendingDestroy(APingActor* Ping);
+
+private:
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	//Min-heap by expire time. Rescheduled or stopped pings leave their old entry behind, it is skipped when popped
+	TArray<FPingExpiration> Expirations;
+	TSet<TWeakObjectPtr<APingActor>> PendingDestroy;
+
+	FDelegateHandle PostActorTickHandle;
+
+	UPROPERTY()
+	TMap<UClass*, FPingActorPool> Pools;
+};
@@ -0,0 +1,29 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APingActor;
+
+/*Fixed size FIFO of the pings one player owns for one ping class, oldest first
+ * Sized from MaxNumberOfPings so counting and evicting the oldest ping never scans*/
+struct FPingRing
+{
+	void Reset(int32 Capacity);
+	int32 Capacity() const { return Slots.Num(); }
+	int32 Num() const { return Count; }
+	bool IsFull() const { return Count >= Slots.Num(); }
+
+	//Adds the ping as the newest entry, the ring must not be full
+	void Push(APingActor* Ping);
+	//Removes the oldest entry, can return null if the ping was destroyed from outside
+	APingActor* Pop();
+	//Removes the ping wherever it is, pings usually expire in order so this is almost always the oldest entry
+	bool Remove(const APingActor* Ping);
+
+private:
+	TArray<TWeakObjectPtr<APingActor>> Slots;
+	int32 Head = 0;
+	int32 Count = 0;
+};
@@ -0,0 +1,61 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChatSystem/ChatHistory.h"
+#include "Styling/SlateTypes.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+class ISlateStyle;
+
+/*Virtualized list of chat messages
+ * Only rows inside the viewport are created and painted, rows are recycled while scrolling
+ * so a long history costs the same per frame as a short one */
+class CHATSYSTEM_API SChatMessageList : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SChatMessageList)
+		: _MaxMessages(1000)
+		, _TextStyle(nullptr)
+		, _DecoratorStyleSet(nullptr)
+		, _AutoScroll(true)
+	{
+	}
+	//Oldest messages are dropped once this many are shown
+	SLATE_ARGUMENT(int32, MaxMessages)
+	SLATE_ARGUMENT(const FTextBlockStyle*, TextStyle)
+	//Styles used by rich text tags such as <Error>
+	SLATE_ARGUMENT(const ISlateStyle*, DecoratorStyleSet)
+	//Keep the newest message in view while the list is scrolled to the bottom
+	SLATE_ARGUMENT(bool, AutoScroll)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	void AddMessage(const FChatHistoryEntry& Entry);
+	void SetMessages(const TArray<FChatHistoryEntry>& Entries);
+	void ClearMessages();
+	int32 GetNumMessages() const { return Items.Num(); }
+
+	void SetMaxMessages(int32 InMaxMessages);
+	void SetTextStyle(const FTextBlockStyle* InTextStyle, const ISlateStyle* InDecoratorStyleSet);
+
+private:
+	typedef TSharedPtr<FChatHistoryEntry> FChatItem;
+
+	TSharedRef<ITableRow> OnGenerateRow(FChatItem Item, const TSharedRef<STableViewBase>& OwnerTable) const;
+	//Drops the oldest messages so no more than MaxMessages are shown
+	void TrimToMaxMessages();
+	void RefreshList(bool bWasAtBottom);
+
+	TArray<FChatItem> Items;
+	TSharedPtr<SListView<FChatItem>> ListView;
+
+	int32 MaxMessages = 1000;
+	bool bAutoScroll = true;
+	const FTextBlockStyle* TextStyle = nullptr;
+	const ISlateStyle* DecoratorStyleSet = nullptr;
+};
@@ -0,0 +1,28 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+using UnrealBuildTool;
+
+public class ChatSystemEditor : ModuleRules
+{
+	public ChatSystemEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine"
+			}
+		);
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new[]
+			{
+				"ChatSystem"
+			}
+		);
+	}
+}
@@ -0,0 +1,257 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatBenchmarkCommandlet.h"
+
+#include "ChatSystemLog.h"
+#include "ChatSystemStats.h"
+#include "ChatTestWorld.h"
+#include "Components/ChatComponent.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/Parse.h"
+#include "Templates/Atomic.h"
+
+namespace
+{
+	int32 ParseInt(const FString& Params, const TCHAR* Name, const int32 Default)
+	{
+		int32 Value = Default;
+		FParse::Value(*Params, Name, Value);
+		return Value;
+	}
+
+	double GetPercentile(TArray<double>& SortedSamples, const double Percentile)
+	{
+		if (SortedSamples.Num() == 0)
+		{
+			return 0.;
+		}
+		const int32 Index = FMath::Clamp(FMath::FloorToInt(Percentile * (SortedSamples.Num() - 1)), 0,
+		                                 SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+
+	/* Forwards to the allocator it replaces and counts the allocations made through it, on every thread.
+	 * Installed as GMalloc only while the benchmark runs, memory is never owned by the proxy so blocks allocated before
+	 * or after can be freed through either allocator */
+	class FChatCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FChatCountingMalloc(FMalloc* InInnerMalloc) : InnerMalloc(InInnerMalloc)
+		{
+		}
+
+		// Both counters include reallocations, they create a new block as often as not
+		TAtomic<int64> NumAllocations{0};
+		TAtomic<int64> AllocatedBytes{0};
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			++NumAllocations;
+			AllocatedBytes += static_cast<int64>(Count);
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			++NumAllocations;
+			AllocatedBytes += static_cast<int64>(Count);
+			return InnerMalloc->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				++NumAllocations;
+				AllocatedBytes += static_cast<int64>(Count);
+			}
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				++NumAllocations;
+				AllocatedBytes += static_cast<int64>(Count);
+			}
+			return InnerMalloc->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			InnerMalloc->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return InnerMalloc->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return InnerMalloc->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			InnerMalloc->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return InnerMalloc->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			return InnerMalloc->ValidateHeap();
+		}
+
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+		{
+			InnerMalloc->GetAllocatorStats(OutStats);
+		}
+
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+		{
+			InnerMalloc->DumpAllocatorStats(Ar);
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return InnerMalloc->GetDescriptiveName();
+		}
+
+	private:
+		FMalloc* InnerMalloc;
+	};
+}
+
+UChatBenchmarkCommandlet::UChatBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UChatBenchmarkCommandlet::Main(const FString& Params)
+{
+	const int32 NumPlayers = FMath::Max(1, ParseInt(Params, TEXT("Players="), 64));
+	const int32 NumTeams = FMath::Clamp(ParseInt(Params, TEXT("Teams="), 4), 1, 254);
+	const int32 NumFrames = FMath::Max(1, ParseInt(Params, TEXT("Frames="), 600));
+	const int32 MessagesPerFrame = FMath::Max(0, ParseInt(Params, TEXT("MessagesPerFrame="), 16));
+	const int32 AllChatPercent = FMath::Clamp(ParseInt(Params, TEXT("AllChatPercent="), 25), 0, 100);
+	const int32 AnnouncementInterval = ParseInt(Params, TEXT("AnnouncementInterval="), 60);
+	const int32 MutePercent = FMath::Clamp(ParseInt(Params, TEXT("MutePercent="), 10), 0, 100);
+	const int32 BanPercent = FMath::Clamp(ParseInt(Params, TEXT("BanPercent="), 5), 0, 100);
+	const int32 MessageLength = FMath::Max(1, ParseInt(Params, TEXT("MessageLength="), 48));
+
+	// Fixed seed so runs are comparable
+	FRandomStream Random(1234);
+
+	// Every simulated player is remote, like on a dedicated server
+	FChatTestWorld TestWorld;
+	TArray<UChatComponent*> Components;
+	Components.Reserve(NumPlayers);
+	for (int32 Index = 0; Index < NumPlayers; ++Index)
+	{
+		Components.Add(TestWorld.AddPlayer(FString::Printf(TEXT("Player%d"), Index), static_cast<uint8>(Index % NumTeams),
+		                                   true));
+	}
+
+	for (UChatComponent* Component : Components)
+	{
+		if (Random.RandRange(1, 100) <= MutePercent)
+		{
+			Component->MutePlayer(Components[Random.RandRange(0, NumPlayers - 1)]->GetPlayerName());
+		}
+		if (Random.RandRange(1, 100) <= BanPercent)
+		{
+			Component->BanPlayerFromChatAndPing(Component->GetPlayerName());
+		}
+	}
+
+	const FString Message = FString::ChrN(MessageLength, TEXT('a'));
+	TArray<double> SendTimes;
+	// Room for the announcements too, so the samples don't allocate inside the measured loop
+	SendTimes.Reserve(NumFrames * (MessagesPerFrame + 1));
+	int32 NumAnnouncements = 0;
+	double FrameEndTime = 0.;
+	// Calls into the client message RPCs, they run locally without a net driver but are counted the same
+	const int64 RpcsBefore = FChatSystemCounters::ClientMessageRpcs;
+	const int64 MessagesSentBefore = FChatSystemCounters::ClientMessagesSent;
+	// Counts every allocation made while the loop runs, including the filter tasks and the end of frame flushes
+	FMalloc* OriginalMalloc = GMalloc;
+	FChatCountingMalloc CountingMalloc(OriginalMalloc);
+	GMalloc = &CountingMalloc;
+	const double StartTime = FPlatformTime::Seconds();
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		for (int32 MessageIndex = 0; MessageIndex < MessagesPerFrame; ++MessageIndex)
+		{
+			UChatComponent* Sender = Components[Random.RandRange(0, NumPlayers - 1)];
+			const bool bSendToAll = Random.RandRange(1, 100) <= AllChatPercent;
+
+			const double SendStart = FPlatformTime::Seconds();
+			Sender->SendString(Message, bSendToAll);
+			SendTimes.Add(FPlatformTime::Seconds() - SendStart);
+		}
+
+		if (AnnouncementInterval > 0 && Frame % AnnouncementInterval == 0)
+		{
+			const double SendStart = FPlatformTime::Seconds();
+			Components[0]->MakeServerAnnouncement(Message);
+			SendTimes.Add(FPlatformTime::Seconds() - SendStart);
+			++NumAnnouncements;
+		}
+
+		// Filter results and outbox flushes are handled at the end of the frame like in a real server
+		const double FrameEndStart = FPlatformTime::Seconds();
+		TestWorld.Tick();
+		FrameEndTime += FPlatformTime::Seconds() - FrameEndStart;
+	}
+
+	const double TotalTime = FPlatformTime::Seconds() - StartTime;
+	GMalloc = OriginalMalloc;
+	const int64 NumAllocations = CountingMalloc.NumAllocations;
+	const int64 AllocatedBytes = CountingMalloc.AllocatedBytes;
+	const int64 ClientRpcs = FChatSystemCounters::ClientMessageRpcs - RpcsBefore;
+	const int64 ClientMessages = FChatSystemCounters::ClientMessagesSent - MessagesSentBefore;
+
+	SendTimes.Sort();
+	double SendTimeSum = 0.;
+	for (const double SendTime : SendTimes)
+	{
+		SendTimeSum += SendTime;
+	}
+	const int32 NumSent = FMath::Max(1, SendTimes.Num());
+
+	UE_LOG(LogChatSystem, Display, TEXT("Chat benchmark: %d players, %d teams, %d frames, %d messages, %d announcements"),
+	       NumPlayers, NumTeams, NumFrames, SendTimes.Num() - NumAnnouncements, NumAnnouncements);
+	UE_LOG(LogChatSystem, Display, TEXT("  Send: avg %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us"),
+	       SendTimeSum / NumSent * 1e6, GetPercentile(SendTimes, 0.5) * 1e6, GetPercentile(SendTimes, 0.99) * 1e6,
+	       GetPercentile(SendTimes, 1.) * 1e6);
+	UE_LOG(LogChatSystem, Display, TEXT("  End of frame: %.2f us per frame, total %.2f ms"),
+	       FrameEndTime / NumFrames * 1e6, TotalTime * 1e3);
+	UE_LOG(LogChatSystem, Display, TEXT("  Client message RPCs: %lld (%.2f per message), messages in them: %lld (%.1f per message)"),
+	       ClientRpcs, static_cast<double>(ClientRpcs) / NumSent, ClientMessages,
+	       static_cast<double>(ClientMessages) / NumSent);
+	UE_LOG(LogChatSystem, Display, TEXT("  Allocations: %lld (%.2f per message), %lld KB (%.1f bytes per message)"),
+	       NumAllocations, static_cast<double>(NumAllocations) / NumSent, AllocatedBytes / 1024,
+	       static_cast<double>(AllocatedBytes) / NumSent);
+	return 0;
+}
@@ -0,0 +1,5 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#include "ChatSystemEditor.h"
+
+IMPLEMENT_MODULE(FChatSystemEditorModule, ChatSystemEditor)
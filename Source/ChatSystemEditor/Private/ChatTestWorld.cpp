@@ -0,0 +1,75 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ChatTestWorld.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "ChatSystem/ChatManager.h"
+#include "Components/ChatComponent.h"
+#include "Engine/DemoNetConnection.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/PlatformProcess.h"
+
+FChatTestWorld::FChatTestWorld()
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ChatTestWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+	// There is no game mode to start play, begin play on the world settings directly
+	World->GetWorldSettings()->NotifyBeginPlay();
+}
+
+FChatTestWorld::~FChatTestWorld()
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+UChatComponent* FChatTestWorld::AddPlayer(const FString& Name, const uint8 TeamIndex, const bool bRemote)
+{
+	// Controllers only exist to own the player state, there is no local player or input to tick
+	APlayerController* PlayerController = World->SpawnActor<APlayerController>();
+	PlayerController->SetActorTickEnabled(false);
+
+	APlayerState* PlayerState = World->SpawnActor<APlayerState>();
+	PlayerState->SetOwner(PlayerController);
+	PlayerState->SetPlayerName(Name);
+	PlayerState->SetPlayerId(NumPlayers++);
+
+	if (bRemote)
+	{
+		// Never connected, having one is enough for the server to send messages to the client instead of keeping them
+		PlayerController->NetConnection = NewObject<UDemoNetConnection>(PlayerController);
+	}
+	else
+	{
+		// The announcement log reaches local players through their controller
+		PlayerController->PlayerState = PlayerState;
+	}
+
+	// Registration with the chat manager happens in the component's BeginPlay
+	UChatComponent* Component = NewObject<UChatComponent>(PlayerState);
+	Component->RegisterComponent();
+	Component->SetTeamIndexOnServer(TeamIndex);
+	return Component;
+}
+
+void FChatTestWorld::Tick(const float DeltaSeconds)
+{
+	// Filtered messages are handed back to the game thread as tasks
+	const UChatManager* ChatManager = UChatManager::GetInstance(World);
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	while (ChatManager && ChatManager->GetNumPendingFilteredMessages() > 0)
+	{
+		FPlatformProcess::Sleep(0.f);
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	}
+
+	World->Tick(LEVELTICK_All, DeltaSeconds);
+}
@@ -0,0 +1,53 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#include "ChatSystem/ChatCompression.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ChatCompressionTests
+{
+	//Writes the string like a replicated property and reads it back like the receiving side
+	bool RoundTrip(const FString& Sent, FString& OutReceived)
+	{
+		FString ToSend = Sent;
+		FBitWriter Writer(0, true);
+		FChatCompression::SerializeString(Writer, ToSend);
+		if (Writer.IsError())
+		{
+			return false;
+		}
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		return FChatCompression::SerializeString(Reader, OutReceived) && !Reader.IsError();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatCompressionOverLimitTest, "ChatSystem.Compression.StringOverLimit",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatCompressionOverLimitTest::RunTest(const FString& Parameters)
+{
+	const int32 MaxBytes = FChatCompression::GetMaxStringBytes();
+
+	// ANSI text one byte over the limit, compressed on the wire
+	FString Received;
+	TestTrue(TEXT("ANSI string over the limit is received"),
+	         ChatCompressionTests::RoundTrip(FString::ChrN(MaxBytes + 1, TEXT('a')), Received));
+	TestEqual(TEXT("ANSI string is cut to the limit"), Received.Len(), MaxBytes);
+
+	// Two byte characters that don't divide the limit evenly, the last one must not be split
+	const FString Wide = FString::ChrN(MaxBytes / 2 + 1, TCHAR(0x00E9));
+	TestTrue(TEXT("UTF-8 string over the limit is received"), ChatCompressionTests::RoundTrip(Wide, Received));
+	TestEqual(TEXT("UTF-8 string is cut to whole characters"), Received, Wide.Left(MaxBytes / 2));
+
+	// Strings within the limit are not touched
+	const FString Fitting = FString::ChrN(MaxBytes, TEXT('b'));
+	TestTrue(TEXT("String at the limit is received"), ChatCompressionTests::RoundTrip(Fitting, Received));
+	TestEqual(TEXT("String at the limit is unchanged"), Received, Fitting);
+	return true;
+}
+
+#endif
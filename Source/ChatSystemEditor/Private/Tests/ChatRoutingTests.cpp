@@ -0,0 +1,178 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#include "ChatSystemStats.h"
+#include "ChatTestWorld.h"
+#include "Components/ChatComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ChatRoutingTests
+{
+	//Messages in the history of a local player that were sent by SenderName
+	int32 CountReceivedFrom(const UChatComponent* Receiver, const FString& SenderName)
+	{
+		TArray<FChatHistoryEntry> Entries;
+		Receiver->GetHistory().GetLast(Receiver->GetHistory().Num(), Entries);
+
+		int32 Count = 0;
+		for (const FChatHistoryEntry& Entry : Entries)
+		{
+			Count += Entry.SenderName == SenderName ? 1 : 0;
+		}
+		return Count;
+	}
+
+	//Messages in the history of a local player that were sent as server messages
+	int32 CountServerMessages(const UChatComponent* Receiver)
+	{
+		TArray<FChatHistoryEntry> Entries;
+		Receiver->GetHistory().GetLast(Receiver->GetHistory().Num(), Entries);
+
+		int32 Count = 0;
+		for (const FChatHistoryEntry& Entry : Entries)
+		{
+			// 255 is used as the TeamIndex for server messages
+			Count += Entry.TeamIndex == 255 ? 1 : 0;
+		}
+		return Count;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatRoutingTeamChatTest, "ChatSystem.Routing.TeamChat",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatRoutingTeamChatTest::RunTest(const FString& Parameters)
+{
+	FChatTestWorld TestWorld;
+	UChatComponent* Sender = TestWorld.AddPlayer(TEXT("Sender"), 0, false);
+	const UChatComponent* TeamMate = TestWorld.AddPlayer(TEXT("TeamMate"), 0, false);
+	const UChatComponent* Enemy = TestWorld.AddPlayer(TEXT("Enemy"), 1, false);
+
+	Sender->SendString(TEXT("Team message"), false);
+	TestWorld.Tick();
+
+	TestEqual(TEXT("Sender receives its team message"), ChatRoutingTests::CountReceivedFrom(Sender, TEXT("Sender")), 1);
+	TestEqual(TEXT("Team mate receives the team message"), ChatRoutingTests::CountReceivedFrom(TeamMate, TEXT("Sender")),
+	          1);
+	TestEqual(TEXT("Enemy doesn't receive the team message"), ChatRoutingTests::CountReceivedFrom(Enemy, TEXT("Sender")),
+	          0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatRoutingAllChatTest, "ChatSystem.Routing.AllChat",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatRoutingAllChatTest::RunTest(const FString& Parameters)
+{
+	FChatTestWorld TestWorld;
+	UChatComponent* Sender = TestWorld.AddPlayer(TEXT("Sender"), 0, false);
+	const UChatComponent* TeamMate = TestWorld.AddPlayer(TEXT("TeamMate"), 0, false);
+	const UChatComponent* Enemy = TestWorld.AddPlayer(TEXT("Enemy"), 1, false);
+
+	Sender->SendString(TEXT("All chat message"), true);
+	TestWorld.Tick();
+
+	TestEqual(TEXT("Sender receives its all chat message"), ChatRoutingTests::CountReceivedFrom(Sender, TEXT("Sender")),
+	          1);
+	TestEqual(TEXT("Team mate receives the all chat message"),
+	          ChatRoutingTests::CountReceivedFrom(TeamMate, TEXT("Sender")), 1);
+	TestEqual(TEXT("Enemy receives the all chat message"), ChatRoutingTests::CountReceivedFrom(Enemy, TEXT("Sender")), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatRoutingAnnouncementTest, "ChatSystem.Routing.Announcement",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatRoutingAnnouncementTest::RunTest(const FString& Parameters)
+{
+	FChatTestWorld TestWorld;
+	const UChatComponent* First = TestWorld.AddPlayer(TEXT("First"), 0, false);
+	const UChatComponent* Second = TestWorld.AddPlayer(TEXT("Second"), 1, false);
+	TestWorld.AddPlayer(TEXT("Remote"), 1, true);
+
+	const int64 RpcsBefore = FChatSystemCounters::ClientMessageRpcs;
+	First->MakeServerAnnouncement(TEXT("Announcement"));
+	TestWorld.Tick();
+
+	TestEqual(TEXT("First player receives the announcement"), ChatRoutingTests::CountServerMessages(First), 1);
+	TestEqual(TEXT("Second player receives the announcement"), ChatRoutingTests::CountServerMessages(Second), 1);
+	// Remote players get announcements from the replicated announcement log
+	TestEqual(TEXT("Announcements don't use the client message RPCs"),
+	          FChatSystemCounters::ClientMessageRpcs - RpcsBefore, static_cast<int64>(0));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatRoutingMuteTest, "ChatSystem.Routing.Mute",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatRoutingMuteTest::RunTest(const FString& Parameters)
+{
+	FChatTestWorld TestWorld;
+	UChatComponent* Sender = TestWorld.AddPlayer(TEXT("Sender"), 0, false);
+	UChatComponent* Muting = TestWorld.AddPlayer(TEXT("Muting"), 0, false);
+	const UChatComponent* Other = TestWorld.AddPlayer(TEXT("Other"), 1, false);
+
+	Muting->MutePlayer(TEXT("Sender"));
+	Sender->SendString(TEXT("Muted message"), true);
+	TestWorld.Tick();
+
+	TestEqual(TEXT("Player who muted the sender doesn't receive the message"),
+	          ChatRoutingTests::CountReceivedFrom(Muting, TEXT("Sender")), 0);
+	TestEqual(TEXT("Other players still receive the message"), ChatRoutingTests::CountReceivedFrom(Other, TEXT("Sender")),
+	          1);
+
+	Muting->UnMutePlayer(TEXT("Sender"));
+	Sender->SendString(TEXT("Unmuted message"), true);
+	TestWorld.Tick();
+
+	TestEqual(TEXT("Unmuted sender is received again"), ChatRoutingTests::CountReceivedFrom(Muting, TEXT("Sender")), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatRoutingBanTest, "ChatSystem.Routing.Ban",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatRoutingBanTest::RunTest(const FString& Parameters)
+{
+	FChatTestWorld TestWorld;
+	UChatComponent* Banned = TestWorld.AddPlayer(TEXT("Banned"), 0, false);
+	const UChatComponent* TeamMate = TestWorld.AddPlayer(TEXT("TeamMate"), 0, false);
+	const UChatComponent* Enemy = TestWorld.AddPlayer(TEXT("Enemy"), 1, false);
+
+	Banned->BanPlayerFromChatAndPing(TEXT("Banned"));
+	Banned->SendString(TEXT("Banned message"), true);
+	TestWorld.Tick();
+
+	TestEqual(TEXT("Team mate doesn't receive messages of a banned player"),
+	          ChatRoutingTests::CountReceivedFrom(TeamMate, TEXT("Banned")), 0);
+	TestEqual(TEXT("Enemy doesn't receive messages of a banned player"),
+	          ChatRoutingTests::CountReceivedFrom(Enemy, TEXT("Banned")), 0);
+	TestEqual(TEXT("Banned player is told about the ban"), ChatRoutingTests::CountServerMessages(Banned), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChatRoutingClientRpcTest, "ChatSystem.Routing.ClientRpcBatching",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FChatRoutingClientRpcTest::RunTest(const FString& Parameters)
+{
+	FChatTestWorld TestWorld;
+	UChatComponent* Sender = TestWorld.AddPlayer(TEXT("Sender"), 0, false);
+	TestWorld.AddPlayer(TEXT("Remote"), 0, true);
+	TestWorld.AddPlayer(TEXT("RemoteEnemy"), 1, true);
+
+	const int64 RpcsBefore = FChatSystemCounters::ClientMessageRpcs;
+	const int64 MessagesBefore = FChatSystemCounters::ClientMessagesSent;
+	Sender->SendString(TEXT("First"), false);
+	Sender->SendString(TEXT("Second"), false);
+	TestWorld.Tick();
+
+	// Only the remote team mate gets the team messages, coalesced into one RPC at the end of the frame
+	TestEqual(TEXT("Client message RPCs"), FChatSystemCounters::ClientMessageRpcs - RpcsBefore, static_cast<int64>(1));
+	TestEqual(TEXT("Messages sent to clients"), FChatSystemCounters::ClientMessagesSent - MessagesBefore,
+	          static_cast<int64>(2));
+	return true;
+}
+
+#endif
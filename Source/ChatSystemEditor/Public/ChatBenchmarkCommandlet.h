@@ -0,0 +1,27 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ChatBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the server side chat path.
+ * Spawns simulated remote players in a local world and drives team chat, all chat, announcements, mutes and bans
+ * through them, then reports the server CPU time, the client message RPCs and the heap allocations per message. Mutes are applied by
+ * the receiving client, they are set up so the run matches a real session but don't change the server cost
+ *
+ * UnrealEditor-Cmd <Project> -run=ChatBenchmark -nullrhi [-Players=64] [-Teams=4] [-Frames=600] [-MessagesPerFrame=16]
+ *     [-AllChatPercent=25] [-AnnouncementInterval=60] [-MutePercent=10] [-BanPercent=5] [-MessageLength=48]
+ */
+UCLASS()
+class CHATSYSTEMEDITOR_API UChatBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UChatBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
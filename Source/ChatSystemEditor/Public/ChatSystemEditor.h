@@ -0,0 +1,9 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "Modules/ModuleManager.h"
+
+class FChatSystemEditorModule : public IModuleInterface
+{
+};
@@ -0,0 +1,33 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UChatComponent;
+class UWorld;
+
+/**
+ * Headless game world with simulated players, shared by the chat benchmark and the automation tests.
+ * Local players keep what they receive in their history. Remote players get a net connection like the players of a
+ * dedicated server, what they receive is queued in their outbox and sent through the client message RPCs
+ */
+class CHATSYSTEMEDITOR_API FChatTestWorld
+{
+public:
+	FChatTestWorld();
+	~FChatTestWorld();
+	UE_NONCOPYABLE(FChatTestWorld);
+
+	UWorld* GetWorld() const { return World; }
+
+	//Spawns a player state with a chat component, names are also used as mute and ban keys
+	UChatComponent* AddPlayer(const FString& Name, uint8 TeamIndex, bool bRemote);
+
+	//Waits for the message filters, then ticks one frame which flushes the outboxes like at the end of a server frame
+	void Tick(float DeltaSeconds = 1.f / 60.f);
+
+private:
+	UWorld* World = nullptr;
+	int32 NumPlayers = 0;
+};
@@ -0,0 +1,36 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+using UnrealBuildTool;
+
+public class ChatSystemReplicationGraph : ModuleRules
+{
+	public ChatSystemReplicationGraph(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"ReplicationGraph"
+			}
+		);
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new[]
+			{
+				"ChatSystem",
+				"NetCore"
+			}
+		);
+
+		// The node tests run in the headless test world of the editor module
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("ChatSystemEditor");
+		}
+	}
+}
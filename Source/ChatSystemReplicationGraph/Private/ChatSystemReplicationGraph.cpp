@@ -0,0 +1,5 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#include "ChatSystemReplicationGraph.h"
+
+IMPLEMENT_MODULE(FChatSystemReplicationGraphModule, ChatSystemReplicationGraph)
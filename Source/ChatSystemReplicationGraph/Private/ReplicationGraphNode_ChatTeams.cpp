@@ -0,0 +1,328 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+
+#include "ReplicationGraphNode_ChatTeams.h"
+
+#include "ChatSystemLog.h"
+#include "ChatSystem/ChatManager.h"
+#include "Components/ChatComponent.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "MapSystem/MapPOI.h"
+#include "PingSystem/PingActor.h"
+#include "PingSystem/PingManager.h"
+
+namespace ChatReplicationGraph
+{
+	// Rep lists had to be prepared before writing before UE5
+	static void ResetRepList(FActorRepListRefView& List)
+	{
+#if ENGINE_MAJOR_VERSION < 5
+		List.PrepareForWrite(true);
+#else
+		List.Reset();
+#endif
+	}
+}
+
+UReplicationGraphNode_ChatTeams::UReplicationGraphNode_ChatTeams()
+{
+	bRequiresPrepareForReplicationCall = true;
+}
+
+bool UReplicationGraphNode_ChatTeams::IsChatActor(const AActor* Actor)
+{
+	return Actor && (Actor->IsA<APingActor>() || Actor->FindComponentByClass<UMapPOI>());
+}
+
+void UReplicationGraphNode_ChatTeams::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	AActor* Actor = ActorInfo.Actor;
+	if (!Actor || ActorTeams.Contains(Actor))
+	{
+		return;
+	}
+
+	const int32 Team = GetActorTeam(Actor);
+	ActorTeams.Add(Actor, Team);
+	AddToBucket(Actor, Team);
+}
+
+bool UReplicationGraphNode_ChatTeams::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo,
+                                                               const bool bWarnIfNotFound)
+{
+	int32 Team = AllTeams;
+	if (!ActorTeams.RemoveAndCopyValue(ActorInfo.Actor, Team))
+	{
+		UE_CLOG(bWarnIfNotFound, LogChatSystem, Warning, TEXT("UReplicationGraphNode_ChatTeams: %s was not in the node"),
+		        *GetNameSafe(ActorInfo.Actor));
+		return false;
+	}
+
+	RemoveFromBucket(ActorInfo.Actor, Team);
+	return true;
+}
+
+void UReplicationGraphNode_ChatTeams::NotifyResetAllNetworkActors()
+{
+	Buckets.Reset();
+	ActorTeams.Reset();
+	ConnectionStates.Reset();
+}
+
+void UReplicationGraphNode_ChatTeams::PrepareForReplication()
+{
+	const UWorld* World = GraphGlobals.IsValid() ? GraphGlobals->World : nullptr;
+	const UChatManager* ChatManager = UChatManager::GetInstance(World);
+	BindPingManager(World);
+
+	// Teams only change when a player changes team, joins or leaves. Reused pings are moved when they are reactivated
+	const uint32 RelevancyEpoch = ChatManager ? ChatManager->GetPingRelevancyEpoch() : 0;
+	const bool bTeamsChanged = RelevancyEpoch != LastRelevancyEpoch;
+
+	// Pawns can be possessed after they were added, pick up their player from time to time as well
+	if (bTeamsChanged || ++FramesSinceTeamRefresh >= TeamRefreshFrames)
+	{
+		FramesSinceTeamRefresh = 0;
+		UpdateActorTeams();
+	}
+
+	if (bTeamsChanged)
+	{
+		// Players leaving change the epoch, drop the state of closed connections
+		for (auto It = ConnectionStates.CreateIterator(); It; ++It)
+		{
+			if (!It.Value().Connection.IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	LastRelevancyEpoch = RelevancyEpoch;
+}
+
+void UReplicationGraphNode_ChatTeams::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	if (const FTeamBucket* Global = Buckets.Find(AllTeams))
+	{
+		if (Global->Actors.Num() > 0)
+		{
+			Params.OutGatheredReplicationLists.AddReplicationActorList(Global->Actors);
+		}
+	}
+
+	if (const FActorRepListRefView* TeamList = GetTeamList(Params.ConnectionManager.NetConnection))
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(*TeamList);
+	}
+}
+
+void UReplicationGraphNode_ChatTeams::GetGatheredActors(UNetConnection* NetConnection, TArray<AActor*>& OutActors)
+{
+	OutActors.Reset();
+	if (const FTeamBucket* Global = Buckets.Find(AllTeams))
+	{
+		for (int32 Index = 0; Index < Global->Actors.Num(); Index++)
+		{
+			OutActors.Add(Global->Actors[Index]);
+		}
+	}
+
+	if (const FActorRepListRefView* TeamList = GetTeamList(NetConnection))
+	{
+		for (int32 Index = 0; Index < TeamList->Num(); Index++)
+		{
+			OutActors.Add((*TeamList)[Index]);
+		}
+	}
+}
+
+const FActorRepListRefView* UReplicationGraphNode_ChatTeams::GetTeamList(UNetConnection* NetConnection)
+{
+	if (!NetConnection)
+	{
+		return nullptr;
+	}
+
+	FConnectionState& State = ConnectionStates.FindOrAdd(NetConnection);
+	if (!State.ChatComponent.IsValid())
+	{
+		State.Connection = NetConnection;
+		State.ChatComponent = FindChatComponent(NetConnection->PlayerController);
+	}
+
+	const UChatComponent* Viewer = State.ChatComponent.Get();
+	if (!Viewer)
+	{
+		return nullptr;
+	}
+
+	const int32 Team = Viewer->GetTeamIndex();
+	const FTeamBucket* Bucket = Buckets.Find(Team);
+	if (!Bucket || Bucket->Actors.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// Most players mute nobody and get the shared team list as is
+	if (!Viewer->HasPingMutedPlayers())
+	{
+		return &Bucket->Actors;
+	}
+
+	const UWorld* World = GraphGlobals.IsValid() ? GraphGlobals->World : nullptr;
+	const UChatManager* ChatManager = UChatManager::GetInstance(World);
+	const uint32 RelevancyEpoch = ChatManager ? ChatManager->GetPingRelevancyEpoch() : 0;
+	if (!State.bFilterValid || State.Team != Team || State.Revision != Bucket->Revision || State.Epoch != RelevancyEpoch)
+	{
+		ChatReplicationGraph::ResetRepList(State.Filtered);
+		for (int32 Index = 0; Index < Bucket->Actors.Num(); Index++)
+		{
+			AActor* Actor = Bucket->Actors[Index];
+			const APingActor* Ping = Cast<APingActor>(Actor);
+			const UChatComponent* OwningChatComponent = Ping ? Ping->GetOwningChatComponent() : nullptr;
+			if (!OwningChatComponent || !Viewer->IsPlayerPingMuted(OwningChatComponent->GetPlayerNameKey()))
+			{
+				State.Filtered.Add(Actor);
+			}
+		}
+
+		State.Team = Team;
+		State.Revision = Bucket->Revision;
+		State.Epoch = RelevancyEpoch;
+		State.bFilterValid = true;
+	}
+
+	return State.Filtered.Num() > 0 ? &State.Filtered : nullptr;
+}
+
+int32 UReplicationGraphNode_ChatTeams::GetActorTeam(const AActor* Actor) const
+{
+	if (const APingActor* Ping = Cast<APingActor>(Actor))
+	{
+		if (Ping->IsGlobalPing)
+		{
+			return AllTeams;
+		}
+		// Same team IsNetRelevantFor uses, the replicated TeamIndex is only a fallback
+		if (const UChatComponent* OwningChatComponent = Ping->GetOwningChatComponent())
+		{
+			return OwningChatComponent->GetTeamIndex();
+		}
+		return Ping->TeamIndex;
+	}
+
+	if (const UChatComponent* ChatComponent = FindChatComponent(Actor))
+	{
+		return ChatComponent->GetTeamIndex();
+	}
+	return AllTeams;
+}
+
+UChatComponent* UReplicationGraphNode_ChatTeams::FindChatComponent(const AActor* Actor)
+{
+	// Walk up the owners until one of them leads to a player state
+	for (const AActor* Current = Actor; Current; Current = Current->GetOwner())
+	{
+		const APlayerState* PlayerState = Cast<APlayerState>(Current);
+		if (!PlayerState)
+		{
+			if (const APawn* Pawn = Cast<APawn>(Current))
+			{
+				PlayerState = Pawn->GetPlayerState();
+			}
+			else if (const AController* Controller = Cast<AController>(Current))
+			{
+				PlayerState = Controller->PlayerState;
+			}
+		}
+
+		if (PlayerState)
+		{
+			return Cast<UChatComponent>(PlayerState->GetComponentByClass(UChatComponent::StaticClass()));
+		}
+	}
+	return nullptr;
+}
+
+void UReplicationGraphNode_ChatTeams::AddToBucket(AActor* Actor, const int32 Team)
+{
+	FTeamBucket* Bucket = Buckets.Find(Team);
+	if (!Bucket)
+	{
+		Bucket = &Buckets.Add(Team);
+		ChatReplicationGraph::ResetRepList(Bucket->Actors);
+	}
+
+	Bucket->Actors.Add(Actor);
+	Bucket->Revision++;
+}
+
+void UReplicationGraphNode_ChatTeams::RemoveFromBucket(AActor* Actor, const int32 Team)
+{
+	if (FTeamBucket* Bucket = Buckets.Find(Team))
+	{
+		Bucket->Actors.RemoveFast(Actor);
+		Bucket->Revision++;
+	}
+}
+
+void UReplicationGraphNode_ChatTeams::UpdateActorTeams()
+{
+	for (auto It = ActorTeams.CreateIterator(); It; ++It)
+	{
+		AActor* Actor = It.Key();
+		const int32 Team = GetActorTeam(Actor);
+		if (Team != It.Value())
+		{
+			RemoveFromBucket(Actor, It.Value());
+			AddToBucket(Actor, Team);
+			It.Value() = Team;
+		}
+	}
+}
+
+void UReplicationGraphNode_ChatTeams::BindPingManager(const UWorld* World)
+{
+	UPingManager* PingManager = UPingManager::GetInstance(World);
+	if (PingManager == BoundPingManager.Get())
+	{
+		return;
+	}
+
+	if (UPingManager* PreviousPingManager = BoundPingManager.Get())
+	{
+		PreviousPingManager->OnPingReactivated.Remove(PingReactivatedHandle);
+	}
+
+	BoundPingManager = PingManager;
+	PingReactivatedHandle = PingManager
+		                        ? PingManager->OnPingReactivated.AddUObject(
+			                        this, &UReplicationGraphNode_ChatTeams::OnPingReactivated)
+		                        : FDelegateHandle();
+}
+
+void UReplicationGraphNode_ChatTeams::OnPingReactivated(APingActor* Ping)
+{
+	int32* Team = ActorTeams.Find(Ping);
+	if (!Team)
+	{
+		return;
+	}
+
+	const int32 NewTeam = GetActorTeam(Ping);
+	if (NewTeam != *Team)
+	{
+		RemoveFromBucket(Ping, *Team);
+		AddToBucket(Ping, NewTeam);
+		*Team = NewTeam;
+	}
+	else if (FTeamBucket* Bucket = Buckets.Find(NewTeam))
+	{
+		// Same team but maybe a new owner, who can be ping muted by other players than the previous one
+		Bucket->Revision++;
+	}
+}
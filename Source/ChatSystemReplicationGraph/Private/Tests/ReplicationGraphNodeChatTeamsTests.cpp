@@ -0,0 +1,158 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#include "ChatTestWorld.h"
+#include "ReplicationGraphNode_ChatTeams.h"
+#include "Components/ChatComponent.h"
+#include "Engine/DemoNetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/AutomationTest.h"
+#include "PingSystem/PingActor.h"
+#include "PingSystem/PingManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+namespace ReplicationGraphNodeChatTeamsTests
+{
+	//Node working on the test world, without a replication graph or net driver around it
+	UReplicationGraphNode_ChatTeams* CreateNode(UWorld* World)
+	{
+		const TSharedPtr<FReplicationGraphGlobalData> GraphGlobals = MakeShared<FReplicationGraphGlobalData>();
+		GraphGlobals->World = World;
+
+		UReplicationGraphNode_ChatTeams* Node = NewObject<UReplicationGraphNode_ChatTeams>();
+		Node->Initialize(GraphGlobals);
+		return Node;
+	}
+
+	//Connection viewing through the player's controller. The controller keeps no net connection, chat stays local
+	UNetConnection* CreateConnection(const UChatComponent* Player)
+	{
+		APlayerController* PlayerController = Cast<APlayerController>(Player->GetOwner()->GetOwner());
+		UNetConnection* Connection = NewObject<UDemoNetConnection>(PlayerController);
+		Connection->PlayerController = PlayerController;
+		return Connection;
+	}
+
+	APingActor* AcquirePing(const UWorld* World, const UChatComponent* Owner)
+	{
+		APlayerState* PlayerState = Cast<APlayerState>(Owner->GetOwner());
+		return UPingManager::GetInstance(World)->AcquirePing(APingActor::StaticClass(), FVector::ZeroVector, PlayerState,
+		                                                     Owner->GetPlayerName(), Owner->GetTeamIndex());
+	}
+
+	bool IsGathered(UReplicationGraphNode_ChatTeams* Node, UNetConnection* Connection, const AActor* Actor)
+	{
+		TArray<AActor*> Actors;
+		Node->GetGatheredActors(Connection, Actors);
+		return Actors.Contains(Actor);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicationGraphNodeChatTeamsBucketingTest, "ChatSystem.ReplicationGraph.TeamBucketing",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FReplicationGraphNodeChatTeamsBucketingTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplicationGraphNodeChatTeamsTests;
+
+	FChatTestWorld TestWorld;
+	const UChatComponent* Pinger = TestWorld.AddPlayer(TEXT("Pinger"), 0, false);
+	const UChatComponent* TeamMate = TestWorld.AddPlayer(TEXT("TeamMate"), 0, false);
+	const UChatComponent* Enemy = TestWorld.AddPlayer(TEXT("Enemy"), 1, false);
+
+	UReplicationGraphNode_ChatTeams* Node = CreateNode(TestWorld.GetWorld());
+	APingActor* TeamPing = AcquirePing(TestWorld.GetWorld(), Pinger);
+	APingActor* GlobalPing = AcquirePing(TestWorld.GetWorld(), Enemy);
+	GlobalPing->IsGlobalPing = true;
+	Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(TeamPing));
+	Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(GlobalPing));
+	Node->PrepareForReplication();
+
+	UNetConnection* PingerConnection = CreateConnection(Pinger);
+	UNetConnection* TeamMateConnection = CreateConnection(TeamMate);
+	UNetConnection* EnemyConnection = CreateConnection(Enemy);
+
+	TestTrue(TEXT("Pinger gets its own ping"), IsGathered(Node, PingerConnection, TeamPing));
+	TestTrue(TEXT("Team mate gets the team ping"), IsGathered(Node, TeamMateConnection, TeamPing));
+	TestFalse(TEXT("Enemy doesn't get the team ping"), IsGathered(Node, EnemyConnection, TeamPing));
+	TestTrue(TEXT("Pinger gets the global ping"), IsGathered(Node, PingerConnection, GlobalPing));
+	TestTrue(TEXT("Enemy gets the global ping"), IsGathered(Node, EnemyConnection, GlobalPing));
+
+	Node->NotifyRemoveNetworkActor(FNewReplicatedActorInfo(TeamPing));
+	TestFalse(TEXT("Removed ping isn't gathered anymore"), IsGathered(Node, TeamMateConnection, TeamPing));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicationGraphNodeChatTeamsMuteTest, "ChatSystem.ReplicationGraph.PingMuteFilter",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FReplicationGraphNodeChatTeamsMuteTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplicationGraphNodeChatTeamsTests;
+
+	FChatTestWorld TestWorld;
+	const UChatComponent* Muted = TestWorld.AddPlayer(TEXT("Muted"), 0, false);
+	const UChatComponent* TeamMate = TestWorld.AddPlayer(TEXT("TeamMate"), 0, false);
+	UChatComponent* Viewer = TestWorld.AddPlayer(TEXT("Viewer"), 0, false);
+	const UChatComponent* Other = TestWorld.AddPlayer(TEXT("Other"), 0, false);
+
+	UReplicationGraphNode_ChatTeams* Node = CreateNode(TestWorld.GetWorld());
+	APingActor* MutedPing = AcquirePing(TestWorld.GetWorld(), Muted);
+	APingActor* TeamMatePing = AcquirePing(TestWorld.GetWorld(), TeamMate);
+	Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(MutedPing));
+	Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(TeamMatePing));
+	Node->PrepareForReplication();
+
+	UNetConnection* ViewerConnection = CreateConnection(Viewer);
+	UNetConnection* OtherConnection = CreateConnection(Other);
+
+	Viewer->MutePlayerPings(TEXT("Muted"));
+	Node->PrepareForReplication();
+	TestFalse(TEXT("Ping of a muted player is filtered"), IsGathered(Node, ViewerConnection, MutedPing));
+	TestTrue(TEXT("Pings of other team mates are kept"), IsGathered(Node, ViewerConnection, TeamMatePing));
+	TestTrue(TEXT("Players that didn't mute still get the ping"), IsGathered(Node, OtherConnection, MutedPing));
+
+	Viewer->UnMutePlayerPings(TEXT("Muted"));
+	Node->PrepareForReplication();
+	TestTrue(TEXT("Ping is gathered again after the unmute"), IsGathered(Node, ViewerConnection, MutedPing));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicationGraphNodeChatTeamsRebucketTest, "ChatSystem.ReplicationGraph.PingReuse",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FReplicationGraphNodeChatTeamsRebucketTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplicationGraphNodeChatTeamsTests;
+
+	FChatTestWorld TestWorld;
+	const UChatComponent* FirstOwner = TestWorld.AddPlayer(TEXT("FirstOwner"), 0, false);
+	const UChatComponent* SecondOwner = TestWorld.AddPlayer(TEXT("SecondOwner"), 1, false);
+
+	// Binds the node to the ping manager of the world
+	UReplicationGraphNode_ChatTeams* Node = CreateNode(TestWorld.GetWorld());
+	Node->PrepareForReplication();
+
+	APingActor* Ping = AcquirePing(TestWorld.GetWorld(), FirstOwner);
+	Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(Ping));
+
+	UNetConnection* FirstConnection = CreateConnection(FirstOwner);
+	UNetConnection* SecondConnection = CreateConnection(SecondOwner);
+	TestTrue(TEXT("First owner's team gets the ping"), IsGathered(Node, FirstConnection, Ping));
+	TestFalse(TEXT("Other team doesn't get the ping"), IsGathered(Node, SecondConnection, Ping));
+
+	// Pooled pings stay in the node while inactive and are reused by the next ping of the same class
+	UPingManager::GetInstance(TestWorld.GetWorld())->ReleasePing(Ping);
+	APingActor* ReusedPing = AcquirePing(TestWorld.GetWorld(), SecondOwner);
+	if (!TestTrue(TEXT("Ping actor is reused"), ReusedPing == Ping))
+	{
+		return false;
+	}
+
+	TestFalse(TEXT("First owner's team loses the reused ping"), IsGathered(Node, FirstConnection, Ping));
+	TestTrue(TEXT("New owner's team gets the reused ping"), IsGathered(Node, SecondConnection, Ping));
+	return true;
+}
+
+#endif
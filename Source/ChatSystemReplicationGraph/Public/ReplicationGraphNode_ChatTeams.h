@@ -0,0 +1,96 @@
+// Copyright 2024 Iraj Mohtasham aurelion.net
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ReplicationGraphNode_ChatTeams.generated.h"
+
+class APingActor;
+class UChatComponent;
+class UPingManager;
+
+/**
+ * Replication graph node for team scoped pings and POI bearing actors.
+ * Actors are bucketed by the team of the player that owns them and only gathered for connections of that team, global
+ * pings and actors without an owning player are gathered for every connection. Ping mutes are applied as a secondary
+ * filter that is only built for connections that muted someone and only rebuilt when their team bucket or the chat
+ * manager's relevancy epoch changes. Pooled pings that are reused are moved on their own when the ping manager
+ * reactivates them.
+ *
+ * Create it in InitGlobalGraphNodes of your replication graph and route the actors IsChatActor accepts to it from
+ * RouteAddNetworkActorToNodes / RouteRemoveNetworkActorToNodes. Routed actors don't need IsNetRelevantFor anymore.
+ * The ChatSystemReplicationGraph module is opt-in, enable the ReplicationGraph plugin in your project and add the
+ * module to the dependencies of the game module that creates the graph.
+ */
+UCLASS()
+class CHATSYSTEMREPLICATIONGRAPH_API UReplicationGraphNode_ChatTeams : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+public:
+	UReplicationGraphNode_ChatTeams();
+
+	//Pings and actors with a map POI, the actors this node is made for
+	static bool IsChatActor(const AActor* Actor);
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+	virtual void PrepareForReplication() override;
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	//Actors gathered for a connection, same lists as GatherActorListsForConnection. Used by the automation tests
+	void GetGatheredActors(UNetConnection* NetConnection, TArray<AActor*>& OutActors);
+
+	//Frames between full team refreshes, catches pawns that got a player after they were added
+	int32 TeamRefreshFrames = 30;
+
+private:
+	//Bucket used for global pings and actors that don't belong to a player
+	static constexpr int32 AllTeams = -1;
+
+	//Team of the player owning the actor, AllTeams if it should replicate to everyone
+	int32 GetActorTeam(const AActor* Actor) const;
+	static UChatComponent* FindChatComponent(const AActor* Actor);
+	//Team bucket of the connection's player, ping mute filtered if they muted someone. Null if nothing to gather
+	const FActorRepListRefView* GetTeamList(UNetConnection* NetConnection);
+
+	void AddToBucket(AActor* Actor, int32 Team);
+	void RemoveFromBucket(AActor* Actor, int32 Team);
+	//Moves actors whose owner changed team
+	void UpdateActorTeams();
+
+	//Listens to pooled pings being reused by the ping manager of the graph's world
+	void BindPingManager(const UWorld* World);
+	//Moves a reused ping to the team of its new owner
+	void OnPingReactivated(APingActor* Ping);
+
+	struct FTeamBucket
+	{
+		FActorRepListRefView Actors;
+		//Changes whenever an actor is added or removed, used to know when filtered lists are stale
+		uint32 Revision = 0;
+	};
+
+	//Ping mute filtered copy of a team bucket for one connection
+	struct FConnectionState
+	{
+		TWeakObjectPtr<UNetConnection> Connection;
+		TWeakObjectPtr<UChatComponent> ChatComponent;
+		int32 Team = AllTeams;
+		uint32 Revision = 0;
+		uint32 Epoch = 0;
+		bool bFilterValid = false;
+		FActorRepListRefView Filtered;
+	};
+
+	TMap<int32, FTeamBucket> Buckets;
+	TMap<AActor*, int32> ActorTeams;
+	TMap<UNetConnection*, FConnectionState> ConnectionStates;
+
+	TWeakObjectPtr<UPingManager> BoundPingManager;
+	FDelegateHandle PingReactivatedHandle;
+
+	uint32 LastRelevancyEpoch = 0;
+	int32 FramesSinceTeamRefresh = 0;
+};